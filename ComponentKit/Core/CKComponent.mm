@@ -137,9 +137,17 @@ struct CKComponentMountInfo {
       CKAssert(v.ck_component == self, @"");
     }
 
+    // When a view is recycled from a component at the same position and size (e.g. an unchanged sibling of a
+    // component whose state changed) it is already in place, so skip the redundant geometry writes.
     const CGPoint anchorPoint = v.layer.anchorPoint;
-    [v setCenter:effectiveContext.position + CGPoint({size.width * anchorPoint.x, size.height * anchorPoint.y})];
-    [v setBounds:{v.bounds.origin, size}];
+    const CGPoint center = effectiveContext.position + CGPoint({size.width * anchorPoint.x, size.height * anchorPoint.y});
+    if (!CGPointEqualToPoint(v.center, center)) {
+      [v setCenter:center];
+    }
+    const CGRect bounds = v.bounds;
+    if (!CGSizeEqualToSize(bounds.size, size)) {
+      [v setBounds:{bounds.origin, size}];
+    }
 
     _mountInfo->viewContext = {v, {{0,0}, v.bounds.size}};
     return {.mountChildren = YES, .contextForChildren = effectiveContext.childContextForSubview(v)};
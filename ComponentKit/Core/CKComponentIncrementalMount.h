@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <memory>
+#import <vector>
+
+#import <QuartzCore/QuartzCore.h>
+#import <UIKit/UIKit.h>
+
+#import <ComponentKit/CKComponentLayout.h>
+
+/**
+ Mounts a layout in a view a slice at a time, so that mounting a large tree can be spread over several run loop turns
+ instead of blowing the frame budget in one go. Components are mounted in the same order as CKMountComponentLayout, and
+ each component's -childrenDidMount (and so its controller's -didMount) is sent only once all of its descendants have
+ been mounted.
+
+ If visibleRect is not null, subtrees that are mounted in their own view and lie entirely outside visibleRect (in the
+ root view's coordinates) are mounted only after everything else. Components are still vended views in order within
+ each view, so this does not change the order of subviews.
+
+ Until it has finished, views recycled from a previous pass that have not been vended yet keep showing their old
+ content. Destroying an unfinished mount stops it: views not vended by then are hidden, components mounted so far stay
+ mounted, and components whose children were not all mounted do not get -childrenDidMount. Nothing else may mount in
+ the view while a mount is in progress. Main thread only.
+ */
+class CKComponentIncrementalMount {
+public:
+  /** Nothing is mounted until mountUntil() is called. */
+  CKComponentIncrementalMount(const CKComponentLayout &layout, UIView *view, CGRect visibleRect = CGRectNull);
+  ~CKComponentIncrementalMount();
+
+  /**
+   Mounts components until everything is mounted or deadline (in CACurrentMediaTime() time) has passed. A component is
+   never mounted partially, so a single slow component may overrun the deadline.
+   @return YES if everything has been mounted.
+   */
+  BOOL mountUntil(CFTimeInterval deadline);
+
+  BOOL isFinished() const;
+
+  /** The generation stamped on the components mounted by this pass; see CKMountComponentLayout. */
+  NSUInteger mountGeneration() const;
+
+  /** The components mounted so far, in mount order. */
+  const std::vector<CKComponent *> &mountedComponents() const;
+
+private:
+  struct State;
+  std::unique_ptr<State> _state;
+
+  CKComponentIncrementalMount(const CKComponentIncrementalMount&) = delete;
+  CKComponentIncrementalMount &operator=(const CKComponentIncrementalMount&) = delete;
+};
+
+/**
+ Mounts layout in view, starting synchronously with a first slice and then mounting a slice at the start of each frame,
+ as signalled by a display link, until frameBudget seconds into the frame (or the end of the frame, if sooner).
+ completion is called on the main thread once everything has been mounted; callers typically use it to unmount the
+ components of a previous pass whose mount generation differs. CKComponentLifecycleManager does this when its
+ mountsIncrementally property is set.
+
+ The mount is cancelled if the returned object is destroyed before it finishes, so callers should hold on to it while
+ it runs and release it before mounting anything else in view.
+ */
+std::shared_ptr<CKComponentIncrementalMount> CKMountComponentLayoutIncrementally(const CKComponentLayout &layout,
+                                                                                 UIView *view,
+                                                                                 CFTimeInterval frameBudget,
+                                                                                 CGRect visibleRect,
+                                                                                 void (^completion)(const CKComponentIncrementalMount &mount));
@@ -0,0 +1,242 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import "CKComponentIncrementalMount.h"
+
+#import <ComponentKit/CKAssert.h>
+
+#import "ComponentUtilities.h"
+#import "CKComponentInternal.h"
+
+using namespace CK::Component;
+
+static const size_t kNoParent = SIZE_MAX;
+
+/**
+ A component that has been mounted and whose descendants may not all have been yet. Since deferred subtrees complete
+ out of DFS order, -childrenDidMount is driven by counting outstanding children rather than by popping the stack.
+ */
+struct MountedNode {
+  CKComponent *component;
+  size_t parent;
+  size_t outstandingChildren;
+};
+
+struct MountItem {
+  /** Points into the layout tree, which the State keeps alive through its copy of the root layout. */
+  const CKComponentLayout *layout;
+  MountContext mountContext;
+  CKComponent *supercomponent;
+  /** The origin of the component in the root view's coordinates. */
+  CGPoint rootPosition;
+  size_t parent;
+};
+
+struct CKComponentIncrementalMount::State {
+  const CKComponentLayout layout;
+  const CGRect visibleRect;
+  const NSUInteger mountGeneration;
+  std::vector<CKComponent *> mountedComponents;
+  std::vector<MountedNode> nodes;
+  std::vector<MountItem> stack;
+  /** Subtrees outside visibleRect, mounted once stack is empty. */
+  std::vector<MountItem> deferred;
+  BOOL deferring;
+
+  State(const CKComponentLayout &l, UIView *view, CGRect r)
+  : layout(l), visibleRect(r), mountGeneration(CKNextMountGeneration()), deferring(!CGRectIsNull(r))
+  {
+    stack.push_back({&layout, MountContext::RootContext(view), nil, CGPointZero, kNoParent});
+  }
+
+  /** Sends -childrenDidMount to the node, then to each ancestor whose last outstanding child it completes. */
+  void complete(size_t index)
+  {
+    while (index != kNoParent) {
+      MountedNode &node = nodes[index];
+      [node.component childrenDidMount];
+      index = node.parent;
+      if (index == kNoParent || --nodes[index].outstandingChildren > 0) {
+        return;
+      }
+    }
+  }
+
+  void mount(const MountItem &item)
+  {
+    const CKComponentLayout &itemLayout = *item.layout;
+    if (itemLayout.component == nil) {
+      // Nil components in a layout struct are invalid, but handle them gracefully
+      nodes.push_back({nil, item.parent, 0});
+      complete(nodes.size() - 1);
+      return;
+    }
+
+    const MountResult mountResult = [itemLayout.component mountInContext:item.mountContext
+                                                                    size:itemLayout.size
+                                                                children:itemLayout.children
+                                                          supercomponent:item.supercomponent];
+    itemLayout.component.mountGeneration = mountGeneration;
+    mountedComponents.push_back(itemLayout.component);
+
+    const size_t childCount = mountResult.mountChildren ? itemLayout.children->size() : 0;
+    nodes.push_back({itemLayout.component, item.parent, childCount});
+    const size_t index = nodes.size() - 1;
+    if (childCount == 0) {
+      complete(index);
+      return;
+    }
+
+    // Only subtrees with a view of their own can be deferred; others vend views from the same container as their
+    // siblings, and must do so in order.
+    const BOOL hasOwnView = mountResult.contextForChildren.viewManager != item.mountContext.viewManager;
+    const CGRect frame = {item.rootPosition, itemLayout.size};
+    std::vector<MountItem> &destination =
+    (deferring && hasOwnView && !CGRectIntersectsRect(frame, visibleRect)) ? deferred : stack;
+
+    // Push children on backwards so the bottom-most component is mounted first.
+    for (auto riter = itemLayout.children->rbegin(); riter != itemLayout.children->rend(); riter++) {
+      destination.push_back({
+        &riter->layout,
+        mountResult.contextForChildren.offset(riter->position, itemLayout.size, riter->layout.size),
+        itemLayout.component,
+        item.rootPosition + riter->position,
+        index,
+      });
+    }
+  }
+};
+
+CKComponentIncrementalMount::CKComponentIncrementalMount(const CKComponentLayout &layout, UIView *view, CGRect visibleRect)
+: _state(new State(layout, view, visibleRect))
+{
+  CKCAssertMainThread();
+}
+
+// Destroying the state releases the mount contexts still on the stacks, whose view managers then hide unvended views.
+CKComponentIncrementalMount::~CKComponentIncrementalMount() {}
+
+BOOL CKComponentIncrementalMount::mountUntil(CFTimeInterval deadline)
+{
+  CKCAssertMainThread();
+  State &state = *_state;
+  while (YES) {
+    if (state.stack.empty()) {
+      if (state.deferred.empty()) {
+        return YES;
+      }
+      // Everything in view has been mounted; deferred subtrees are all off-screen, so mount them without deferring.
+      state.stack.swap(state.deferred);
+      state.deferring = NO;
+    }
+    // Copy the item out since mounting pushes onto the stack.
+    const MountItem item = state.stack.back();
+    state.stack.pop_back();
+    state.mount(item);
+    // Check the deadline only after mounting, so that every slice makes progress.
+    if (CACurrentMediaTime() >= deadline) {
+      return isFinished();
+    }
+  }
+}
+
+BOOL CKComponentIncrementalMount::isFinished() const
+{
+  return _state->stack.empty() && _state->deferred.empty();
+}
+
+NSUInteger CKComponentIncrementalMount::mountGeneration() const
+{
+  return _state->mountGeneration;
+}
+
+const std::vector<CKComponent *> &CKComponentIncrementalMount::mountedComponents() const
+{
+  return _state->mountedComponents;
+}
+
+/** Mounts a slice of an incremental mount at the start of each frame until it finishes or is destroyed. */
+@interface CKComponentIncrementalMountDriver : NSObject
+- (instancetype)initWithMount:(const std::shared_ptr<CKComponentIncrementalMount> &)mount
+                  frameBudget:(CFTimeInterval)frameBudget
+                   completion:(void (^)(const CKComponentIncrementalMount &mount))completion;
+- (void)start;
+@end
+
+@implementation CKComponentIncrementalMountDriver
+{
+  std::weak_ptr<CKComponentIncrementalMount> _mount;
+  CFTimeInterval _frameBudget;
+  void (^_completion)(const CKComponentIncrementalMount &mount);
+  CADisplayLink *_displayLink;
+}
+
+- (instancetype)initWithMount:(const std::shared_ptr<CKComponentIncrementalMount> &)mount
+                  frameBudget:(CFTimeInterval)frameBudget
+                   completion:(void (^)(const CKComponentIncrementalMount &mount))completion
+{
+  if (self = [super init]) {
+    _mount = mount;
+    _frameBudget = frameBudget;
+    _completion = completion;
+  }
+  return self;
+}
+
+- (void)start
+{
+  // The display link retains its target until it is invalidated, which keeps the driver alive while the mount runs.
+  _displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(displayLinkDidFire:)];
+  [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+}
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink
+{
+  const std::shared_ptr<CKComponentIncrementalMount> mount = _mount.lock();
+  if (!mount) {
+    [self _stop]; // Cancelled.
+    return;
+  }
+  // The timestamp is when the last frame was displayed, which is when work on the next one starts.
+  const CFTimeInterval deadline = displayLink.timestamp + MIN(_frameBudget, displayLink.duration);
+  if (mount->mountUntil(deadline)) {
+    [self _stop];
+    if (_completion) {
+      _completion(*mount);
+    }
+  }
+}
+
+- (void)_stop
+{
+  [_displayLink invalidate];
+  _displayLink = nil;
+}
+
+@end
+
+std::shared_ptr<CKComponentIncrementalMount> CKMountComponentLayoutIncrementally(const CKComponentLayout &layout,
+                                                                                 UIView *view,
+                                                                                 CFTimeInterval frameBudget,
+                                                                                 CGRect visibleRect,
+                                                                                 void (^completion)(const CKComponentIncrementalMount &mount))
+{
+  CKCAssertMainThread();
+  const auto mount = std::make_shared<CKComponentIncrementalMount>(layout, view, visibleRect);
+  // The first slice runs now, with no way of telling how much of the current frame is left; give it a whole budget.
+  if (mount->mountUntil(CACurrentMediaTime() + frameBudget)) {
+    if (completion) {
+      completion(*mount);
+    }
+  } else {
+    [[[CKComponentIncrementalMountDriver alloc] initWithMount:mount frameBudget:frameBudget completion:completion] start];
+  }
+  return mount;
+}
@@ -55,6 +55,12 @@
 
 - (id)nextResponderAfterController;
 
+/**
+ Stamped by CKMountComponentLayout on every component it mounts. A component whose generation differs from the latest
+ pass was not part of that pass and should be unmounted by whoever mounted it.
+ */
+@property (nonatomic, assign) NSUInteger mountGeneration;
+
 /** Called by the CKComponentLifecycleManager when the component and all its children have been mounted. */
 - (void)childrenDidMount;
 
@@ -71,3 +77,6 @@
 @property (nonatomic, strong, readonly) id scopeFrameToken;
 
 @end
+
+/** Returns a new mount generation, distinct from all previous ones. Main thread only. */
+NSUInteger CKNextMountGeneration();
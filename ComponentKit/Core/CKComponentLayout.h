@@ -44,5 +44,20 @@ struct CKComponentLayoutChild {
   CKComponentLayout layout;
 };
 
+/**
+ Recursively mounts the layout in the view.
+
+ Each mounted component is stamped with a new mount generation (see -[CKComponent mountGeneration]) and appended to
+ mountedComponents, which is cleared first. Callers that keep the vector of the previous pass can then find components
+ to unmount with a linear scan for stale generations instead of set differencing; reusing the same vectors across
+ passes keeps this allocation-free.
+
+ @return The mount generation stamped on the components mounted during this pass.
+ */
+NSUInteger CKMountComponentLayout(const CKComponentLayout &layout,
+                                  UIView *view,
+                                  std::vector<CKComponent *> &mountedComponents,
+                                  CKComponent *supercomponent = nil);
+
 /** Recursively mounts the layout in the view, returning a set of the mounted components. */
 NSSet *CKMountComponentLayout(const CKComponentLayout &layout, UIView *view, CKComponent *supercomponent = nil);
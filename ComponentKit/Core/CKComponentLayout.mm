@@ -31,8 +31,23 @@ void CKOffMainThreadDeleter::operator()(std::vector<CKComponentLayoutChild> *tar
   }
 }
 
-NSSet *CKMountComponentLayout(const CKComponentLayout &layout, UIView *view, CKComponent *supercomponent)
+NSUInteger CKNextMountGeneration()
 {
+  CKCAssertMainThread();
+  // Generations are only ever compared for equality, and only on the main thread, so a plain counter suffices.
+  static NSUInteger lastMountGeneration = 0;
+  return ++lastMountGeneration;
+}
+
+NSUInteger CKMountComponentLayout(const CKComponentLayout &layout,
+                                  UIView *view,
+                                  std::vector<CKComponent *> &mountedComponents,
+                                  CKComponent *supercomponent)
+{
+  CKCAssertMainThread();
+  const NSUInteger mountGeneration = CKNextMountGeneration();
+  mountedComponents.clear();
+
   struct MountItem {
     const CKComponentLayout &layout;
     MountContext mountContext;
@@ -44,7 +59,6 @@ NSSet *CKMountComponentLayout(const CKComponentLayout &layout, UIView *view, CKC
   // of the tree
   std::stack<MountItem> stack;
   stack.push({layout, MountContext::RootContext(view), supercomponent, NO});
-  NSMutableSet *mountedComponents = [NSMutableSet set];
 
   while (!stack.empty()) {
     MountItem &item = stack.top();
@@ -60,7 +74,8 @@ NSSet *CKMountComponentLayout(const CKComponentLayout &layout, UIView *view, CKC
                                                                        size:item.layout.size
                                                                    children:item.layout.children
                                                              supercomponent:item.supercomponent];
-      [mountedComponents addObject:item.layout.component];
+      item.layout.component.mountGeneration = mountGeneration;
+      mountedComponents.push_back(item.layout.component);
 
       if (mountResult.mountChildren) {
         // Ordering of components should correspond to ordering of mount. Push components on backwards so the
@@ -71,5 +86,16 @@ NSSet *CKMountComponentLayout(const CKComponentLayout &layout, UIView *view, CKC
       }
     }
   }
-  return mountedComponents;
+  return mountGeneration;
+}
+
+NSSet *CKMountComponentLayout(const CKComponentLayout &layout, UIView *view, CKComponent *supercomponent)
+{
+  std::vector<CKComponent *> mountedComponents;
+  CKMountComponentLayout(layout, view, mountedComponents, supercomponent);
+  NSMutableSet *set = [NSMutableSet setWithCapacity:mountedComponents.size()];
+  for (CKComponent *component : mountedComponents) {
+    [set addObject:component];
+  }
+  return set;
 }
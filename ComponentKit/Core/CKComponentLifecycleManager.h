@@ -42,6 +42,14 @@ extern const CKComponentLifecycleManagerState CKComponentLifecycleManagerStateEm
 
 @property (nonatomic, weak) id<CKComponentLifecycleManagerDelegate> delegate;
 
+/**
+ When YES, layouts are mounted a slice per frame (see CKMountComponentLayoutIncrementally) instead of all at once, with
+ components inside the view's bounds mounted first. Components of the previous layout are unmounted once the new one
+ has been fully mounted; until then, views that have not been recycled yet keep showing their old content. A new
+ update, or detaching, stops a mount that has not finished. Defaults to NO.
+ */
+@property (nonatomic, assign) BOOL mountsIncrementally;
+
 - (CKComponentLifecycleManagerState)prepareForUpdateWithModel:(id)model constrainedSize:(CKSizeRange)constrainedSize context:(id<NSObject>)context;
 
 - (CKComponentLayout)layoutForModel:(id)model constrainedSize:(CKSizeRange)constrainedSize context:(id<NSObject>)context;
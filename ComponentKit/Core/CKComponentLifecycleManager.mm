@@ -12,9 +12,12 @@
 #import "CKComponentLifecycleManagerInternal.h"
 #import "CKComponentLifecycleManager_Private.h"
 
+#import <memory>
 #import <stack>
+#import <vector>
 
 #import "CKComponent.h"
+#import "CKComponentIncrementalMount.h"
 #import "CKComponentInternal.h"
 #import "CKComponentLayout.h"
 #import "CKComponentLifecycleManagerAsynchronousUpdateHandler.h"
@@ -29,6 +32,44 @@
 
 using CK::Component::MountContext;
 
+/** Half of a 60Hz frame, leaving the rest for layout and committing the frame. */
+static const CFTimeInterval kIncrementalMountFrameBudget = 1.0 / 120.0;
+
+/**
+ The layout is mounted at the origin of the view's coordinate space, so the part of the view's bounds that lies within
+ its window is also the visible part of the layout. Returns CGRectNull, so that nothing is deferred, if the view is not
+ in a window.
+ */
+static CGRect visibleRectOfLayoutInView(UIView *view)
+{
+  UIWindow *window = view.window;
+  if (!window) {
+    return CGRectNull;
+  }
+  const CGRect visibleRect = CGRectIntersection(view.bounds, [view convertRect:window.bounds fromView:window]);
+  // A view scrolled entirely out of its window shows nothing, so everything that can be deferred should be.
+  return CGRectIsNull(visibleRect) ? CGRectZero : visibleRect;
+}
+
+/**
+ Components mounted by both the previous pass and an unfinished incremental pass were stamped with the latter's
+ generation, so they are only taken from the incremental pass to keep each component listed once.
+ */
+static std::vector<CKComponent *> mergeMountedComponents(const std::vector<CKComponent *> &previouslyMounted,
+                                                         const CKComponentIncrementalMount &incrementalMount)
+{
+  const NSUInteger mountGeneration = incrementalMount.mountGeneration();
+  std::vector<CKComponent *> merged;
+  for (CKComponent *component : previouslyMounted) {
+    if (component.mountGeneration != mountGeneration) {
+      merged.push_back(component);
+    }
+  }
+  const std::vector<CKComponent *> &mounted = incrementalMount.mountedComponents();
+  merged.insert(merged.end(), mounted.begin(), mounted.end());
+  return merged;
+}
+
 const CKComponentLifecycleManagerState CKComponentLifecycleManagerStateEmpty = {
   .model = nil,
   .constrainedSize = {},
@@ -39,7 +80,12 @@ const CKComponentLifecycleManagerState CKComponentLifecycleManagerStateEmpty = {
 @implementation CKComponentLifecycleManager
 {
   UIView *_mountedView;
-  NSSet *_mountedComponents;
+  /** Components mounted by the last pass; the vectors are swapped on each pass so their storage is reused. */
+  std::vector<CKComponent *> _mountedComponents;
+  std::vector<CKComponent *> _previouslyMountedComponents;
+  CKComponentMountStatistics _lastMountStatistics;
+  /** The unfinished incremental mount, if any; destroying it stops it. */
+  std::shared_ptr<CKComponentIncrementalMount> _incrementalMount;
 
   Class<CKComponentProvider> _componentProvider;
   id<CKComponentSizeRangeProviding> _sizeRangeProvider;
@@ -66,10 +112,14 @@ const CKComponentLifecycleManagerState CKComponentLifecycleManagerStateEmpty = {
 
 - (void)dealloc
 {
-  if (_mountedComponents) {
-    NSSet *componentsToUnmount = _mountedComponents;
+  // An unfinished incremental mount is main thread only, so the block keeps it alive until it has run.
+  const std::shared_ptr<CKComponentIncrementalMount> incrementalMount = _incrementalMount;
+  if (!_mountedComponents.empty() || incrementalMount) {
+    const std::vector<CKComponent *> mountedComponents = _mountedComponents;
     dispatch_block_t unmountBlock = ^{
-      for (CKComponent *c in componentsToUnmount) {
+      const std::vector<CKComponent *> componentsToUnmount =
+      incrementalMount ? mergeMountedComponents(mountedComponents, *incrementalMount) : mountedComponents;
+      for (CKComponent *c : componentsToUnmount) {
         [c unmount];
       }
     };
@@ -138,16 +188,65 @@ const CKComponentLifecycleManagerState CKComponentLifecycleManagerStateEmpty = {
 
 - (void)_mountLayout
 {
-  NSSet *newMountedComponents = CKMountComponentLayout(_state.layout, _mountedView);
+  [self _stopIncrementalMount];
+  if (_mountsIncrementally) {
+    [self _mountLayoutIncrementally];
+    return;
+  }
+
+  _previouslyMountedComponents.swap(_mountedComponents);
+  const NSUInteger mountGeneration = CKMountComponentLayout(_state.layout, _mountedView, _mountedComponents);
   _state.layout.component.rootComponentMountedView = _mountedView;
+  [self _unmountPreviouslyMountedComponentsOutsideGeneration:mountGeneration];
+}
 
-  // Unmount any components that were in _mountedComponents but are no longer in newMountedComponents.
-  NSMutableSet *componentsToUnmount = [_mountedComponents mutableCopy];
-  [componentsToUnmount minusSet:newMountedComponents];
-  for (CKComponent *component in componentsToUnmount) {
-    [component unmount];
+- (void)_mountLayoutIncrementally
+{
+  _state.layout.component.rootComponentMountedView = _mountedView;
+  __weak CKComponentLifecycleManager *weakSelf = self;
+  const auto mount = CKMountComponentLayoutIncrementally(_state.layout, _mountedView, kIncrementalMountFrameBudget,
+                                                         visibleRectOfLayoutInView(_mountedView),
+                                                         ^(const CKComponentIncrementalMount &m) {
+                                                           [weakSelf _incrementalMountDidFinish:m];
+                                                         });
+  // The first slice runs synchronously and may already have mounted everything.
+  if (!mount->isFinished()) {
+    _incrementalMount = mount;
   }
-  _mountedComponents = [newMountedComponents copy];
+}
+
+- (void)_incrementalMountDidFinish:(const CKComponentIncrementalMount &)mount
+{
+  _previouslyMountedComponents.swap(_mountedComponents);
+  _mountedComponents = mount.mountedComponents();
+  [self _unmountPreviouslyMountedComponentsOutsideGeneration:mount.mountGeneration()];
+  _incrementalMount.reset();
+}
+
+/** Components mounted by an unfinished pass stay mounted, so they are handed to the next pass to unmount. */
+- (void)_stopIncrementalMount
+{
+  if (_incrementalMount) {
+    _mountedComponents = mergeMountedComponents(_mountedComponents, *_incrementalMount);
+    _incrementalMount.reset();
+  }
+}
+
+/** Unmounts any components from the previous pass that were not stamped with this pass's generation. */
+- (void)_unmountPreviouslyMountedComponentsOutsideGeneration:(NSUInteger)mountGeneration
+{
+  NSUInteger unmountedCount = 0;
+  for (CKComponent *component : _previouslyMountedComponents) {
+    if (component.mountGeneration != mountGeneration) {
+      [component unmount];
+      unmountedCount++;
+    }
+  }
+  _previouslyMountedComponents.clear();
+  _lastMountStatistics = {
+    .mountedCount = _mountedComponents.size(),
+    .unmountedCount = unmountedCount,
+  };
 }
 
 - (void)attachToView:(UIView *)view
@@ -172,10 +271,15 @@ const CKComponentLifecycleManagerState CKComponentLifecycleManagerStateEmpty = {
 {
   if (_mountedView) {
     CKAssert(_mountedView.ck_componentLifecycleManager == self, @"");
-    for (CKComponent *component in _mountedComponents) {
+    [self _stopIncrementalMount];
+    for (CKComponent *component : _mountedComponents) {
       [component unmount];
     }
-    _mountedComponents = nil;
+    _lastMountStatistics = {
+      .mountedCount = 0,
+      .unmountedCount = _mountedComponents.size(),
+    };
+    _mountedComponents.clear();
     _mountedView.ck_componentLifecycleManager = nil;
     _mountedView = nil;
   }
@@ -227,4 +331,9 @@ const CKComponentLifecycleManagerState CKComponentLifecycleManagerStateEmpty = {
   return _state;
 }
 
+- (CKComponentMountStatistics)lastMountStatistics
+{
+  return _lastMountStatistics;
+}
+
 @end
@@ -11,6 +11,13 @@
 #import <ComponentKit/CKComponentLifecycleManager.h>
 #import <ComponentKit/CKComponentScopeInternal.h>
 
+struct CKComponentMountStatistics {
+  /** Number of components mounted by the pass. */
+  NSUInteger mountedCount;
+  /** Number of previously mounted components that the pass unmounted. */
+  NSUInteger unmountedCount;
+};
+
 /**
  Debug Purposes Only.
  */
@@ -18,4 +25,7 @@
 
 - (CKComponentLifecycleManagerState)state;
 
+/** Counts from the most recent mount (or detach) pass. */
+- (CKComponentMountStatistics)lastMountStatistics;
+
 @end
@@ -8,8 +8,14 @@
  *
  */
 
+#import <initializer_list>
+#import <memory>
 #import <string>
+#import <type_traits>
 #import <unordered_map>
+#import <utility>
+
+#import <objc/runtime.h>
 
 #import <UIKit/UIKit.h>
 
@@ -22,6 +28,10 @@ struct CKComponentViewAttribute {
    The most common way to specify an attribute is by using a SEL corresponding to a setter, e.g. @selector(setColor:).
    This single-argument constructor allows implicit conversions, so you can pass a SEL as an attribute without actually
    typing CKComponentViewAttribute().
+
+   Setters taking objects are sent as regular messages. Setters taking numbers or structs are called through an IMP that
+   is looked up once per class and never invalidated, so swizzling such a setter, or adding it in a category, after it
+   has first been applied to a view of that class has no effect on later mounts.
    */
   CKComponentViewAttribute(SEL setter);
   /**
@@ -60,12 +70,19 @@ struct CKComponentViewAttribute {
                            void (^unapp)(id view, id value) = nil,
                            void (^upd)(id view, id oldValue, id newValue) = nil) :
   identifier(ident),
+  internedIdentifier(internIdentifier(ident)),
   applicator(app),
   unapplicator(unapp),
   updater(upd) {};
 
   ~CKComponentViewAttribute();
 
+  // Declaring the destructor suppresses the implicit move operations, which CKViewComponentAttributeValueMap relies on.
+  CKComponentViewAttribute(const CKComponentViewAttribute &) = default;
+  CKComponentViewAttribute(CKComponentViewAttribute &&) = default;
+  CKComponentViewAttribute &operator=(const CKComponentViewAttribute &) = default;
+  CKComponentViewAttribute &operator=(CKComponentViewAttribute &&) = default;
+
   /**
    Creates an attribute that invokes the given setter on the view's layer (rather than the view itself). Useful for
    easy access to layer properties, e.g. @selector(setBorderColor:), @selector(setAnchorPoint:), and so on.
@@ -73,11 +90,26 @@ struct CKComponentViewAttribute {
   static CKComponentViewAttribute LayerAttribute(SEL setter);
 
   std::string identifier;
+  /**
+   A small integer uniquely identifying `identifier` for the lifetime of the process. Equality, hashing and persistent
+   attribute shapes use this instead of comparing strings.
+   */
+  int32_t internedIdentifier;
   void (^applicator)(id view, id value);
   void (^unapplicator)(id view, id value);
   void (^updater)(id view, id oldValue, id newValue);
+  /**
+   The setter of attributes created from a SEL (including layer and typed attributes), which view configurations
+   resolve ahead of the first mount; NULL for complex attributes.
+   */
+  SEL setter = NULL;
+  /** Whether setter is sent to the view's layer rather than to the view. */
+  bool setterTargetsLayer = false;
+
+  bool operator==(const CKComponentViewAttribute &attr) const { return internedIdentifier == attr.internedIdentifier; };
 
-  bool operator==(const CKComponentViewAttribute &attr) const { return identifier == attr.identifier; };
+  /** Returns the interned integer for an attribute identifier. Thread-safe; lock-free once a string has been seen. */
+  static int32_t internIdentifier(const std::string &ident);
 };
 
 namespace std {
@@ -85,18 +117,229 @@ namespace std {
   {
     size_t operator()(const CKComponentViewAttribute &attr) const
     {
-      return hash<std::string>()(attr.identifier);
+      return hash<int32_t>()(attr.internedIdentifier);
     }
   };
 }
 
-typedef std::unordered_map<CKComponentViewAttribute, id> CKViewComponentAttributeValueMap;
+/**
+ Maps attributes to their values. Views usually have only a handful of attributes, so rather than a hash table this is
+ an array sorted by interned attribute identifier, stored inline up to kInlineCapacity entries and on the heap beyond.
+ Lookups are binary searches, and two maps can be compared or diffed by walking them in step.
+
+ It implements the subset of the std::unordered_map interface used with attributes, including construction from an
+ initializer list; as with std::unordered_map, inserting an attribute that is already present does not replace it.
+ Iteration is in identifier order and only exposes const elements, since mutating a key would break the ordering.
+ */
+class CKViewComponentAttributeValueMap {
+public:
+  typedef CKComponentViewAttribute key_type;
+  typedef id mapped_type;
+  typedef std::pair<CKComponentViewAttribute, id> value_type;
+  typedef const value_type *const_iterator;
+  typedef const_iterator iterator;
+
+  CKViewComponentAttributeValueMap() : _elements(inlineElements()), _size(0), _capacity(kInlineCapacity) {};
+  CKViewComponentAttributeValueMap(std::initializer_list<value_type> values);
+  CKViewComponentAttributeValueMap(const CKViewComponentAttributeValueMap &other);
+  CKViewComponentAttributeValueMap(CKViewComponentAttributeValueMap &&other);
+  CKViewComponentAttributeValueMap &operator=(const CKViewComponentAttributeValueMap &other);
+  CKViewComponentAttributeValueMap &operator=(CKViewComponentAttributeValueMap &&other);
+  ~CKViewComponentAttributeValueMap();
+
+  const_iterator begin() const { return _elements; };
+  const_iterator end() const { return _elements + _size; };
+  size_t size() const { return _size; };
+  bool empty() const { return _size == 0; };
+
+  const_iterator find(const key_type &key) const;
+
+  std::pair<const_iterator, bool> insert(const value_type &value);
+  std::pair<const_iterator, bool> insert(value_type &&value);
+  void insert(std::initializer_list<value_type> values) { insert(values.begin(), values.end()); };
+  template <typename InputIterator>
+  void insert(InputIterator first, InputIterator last)
+  {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  };
+
+  /** Returns the value for key, inserting a nil value first if key is not present. */
+  id &operator[](const key_type &key);
+
+private:
+  static const uint32_t kInlineCapacity = 4;
+
+  value_type *inlineElements() { return reinterpret_cast<value_type *>(&_inlineStorage); };
+  bool isInline() const { return _elements == reinterpret_cast<const value_type *>(&_inlineStorage); };
+  value_type *lowerBound(int32_t internedIdentifier) const;
+  void reserve(uint32_t capacity);
+  void clear();
+  void moveFrom(CKViewComponentAttributeValueMap &&other);
+
+  value_type *_elements;
+  uint32_t _size;
+  uint32_t _capacity;
+  std::aligned_storage<sizeof(value_type) * kInlineCapacity, alignof(value_type)>::type _inlineStorage;
+};
+
+/**
+ Resolves how setter is invoked on instances of viewClass (its IMP and how to unbox NSNumber/NSValue arguments) and
+ caches the result. CKComponentViewConfiguration calls this for the setters of its attributes when it is built, so the
+ work happens while preparing components in the background instead of during the first mount; views that come from a
+ factory rather than a class resolve their setters the first time they are applied. Safe to call from any thread.
+ Asserts if viewClass does not respond to setter. The resolved IMP is never invalidated; see CKComponentViewAttribute(SEL).
+ */
+void CKComponentViewAttributePrepareSetter(Class viewClass, SEL setter);
 
 /**
  This typedef is provided for convenience for helper functions that return both an attribute and a value, ready-made
  for dropping into the initialization list for attributes.
  e.g: It is currently used in CKComponentViewConfiguration, CKComponentViewConfiguration.attribute is of type
- std::unordered_map<CKComponentViewAttribute, id> (CKViewComponentAttributeValueMap). Its aggregate initialization
- constructor takes a list of std::pair<CKComponentViewAttribute, id>.
+ CKViewComponentAttributeValueMap. Its initializer list constructor takes a list of
+ std::pair<CKComponentViewAttribute, id>.
  */
 typedef CKViewComponentAttributeValueMap::value_type CKComponentViewAttributeValue;
+
+namespace CK {
+  namespace Component {
+    /** A distinct address per type, so type-erased values of different types never compare equal. */
+    template <typename T>
+    const void *TypedAttributeTypeTag()
+    {
+      static const char tag = 0;
+      return &tag;
+    }
+
+    /** Typed values are compared with operator==; CoreGraphics and UIKit structs use their own equality functions. */
+    template <typename T>
+    bool TypedAttributeValuesEqual(const T &a, const T &b) { return a == b; }
+    inline bool TypedAttributeValuesEqual(const CGPoint &a, const CGPoint &b) { return CGPointEqualToPoint(a, b); }
+    inline bool TypedAttributeValuesEqual(const CGSize &a, const CGSize &b) { return CGSizeEqualToSize(a, b); }
+    inline bool TypedAttributeValuesEqual(const CGRect &a, const CGRect &b) { return CGRectEqualToRect(a, b); }
+    inline bool TypedAttributeValuesEqual(const UIEdgeInsets &a, const UIEdgeInsets &b)
+    {
+      return UIEdgeInsetsEqualToEdgeInsets(a, b);
+    }
+    inline bool TypedAttributeValuesEqual(const CGAffineTransform &a, const CGAffineTransform &b)
+    {
+      return CGAffineTransformEqualToTransform(a, b);
+    }
+    inline bool TypedAttributeValuesEqual(const CATransform3D &a, const CATransform3D &b)
+    {
+      return CATransform3DEqualToTransform(a, b);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, size_t>::type TypedAttributeValueHash(const T &value)
+    {
+      return std::hash<T>()(value);
+    }
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value, size_t>::type TypedAttributeValueHash(const T &value)
+    {
+      typedef typename std::underlying_type<T>::type U;
+      return std::hash<U>()(static_cast<U>(value));
+    }
+    /** Values of other types all share one hash, which is consistent with any equality. */
+    template <typename T>
+    typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_enum<T>::value, size_t>::type
+    TypedAttributeValueHash(const T &)
+    {
+      return 0;
+    }
+    inline size_t TypedAttributeValueHash(const CGPoint &p)
+    {
+      return std::hash<CGFloat>()(p.x) * 31 + std::hash<CGFloat>()(p.y);
+    }
+    inline size_t TypedAttributeValueHash(const CGSize &s)
+    {
+      return std::hash<CGFloat>()(s.width) * 31 + std::hash<CGFloat>()(s.height);
+    }
+    inline size_t TypedAttributeValueHash(const CGRect &r)
+    {
+      return TypedAttributeValueHash(r.origin) * 31 + TypedAttributeValueHash(r.size);
+    }
+
+    /** Type-erased storage for a typed attribute value. */
+    struct TypedAttributeValueBase {
+      virtual ~TypedAttributeValueBase() {}
+      virtual const void *typeTag() const = 0;
+      virtual bool isEqual(const TypedAttributeValueBase &other) const = 0;
+      virtual size_t hash() const = 0;
+    };
+
+    /** Holds a T by value, so each typed attribute value takes exactly as much storage as its type. */
+    template <typename T>
+    struct TypedAttributeValue : TypedAttributeValueBase {
+      explicit TypedAttributeValue(const T &v) : value(v) {}
+
+      const void *typeTag() const override { return TypedAttributeTypeTag<T>(); }
+      bool isEqual(const TypedAttributeValueBase &other) const override
+      {
+        return other.typeTag() == typeTag()
+        && TypedAttributeValuesEqual(value, static_cast<const TypedAttributeValue<T> &>(other).value);
+      }
+      size_t hash() const override { return TypedAttributeValueHash(value); }
+
+      const T value;
+    };
+
+    /**
+     Wraps a typed value in a minimal immutable object, since attribute values are objects. Two boxes are equal if they
+     hold values of the same type that compare equal, so recycled views compare typed values without going through
+     NSNumber or NSValue.
+     */
+    id BoxTypedAttributeValue(std::unique_ptr<const TypedAttributeValueBase> value);
+    /** Returns the value stored by BoxTypedAttributeValue. */
+    const TypedAttributeValueBase &UnboxTypedAttributeValue(id box);
+
+    /**
+     Returns the IMP of setter for instances of cls from the same lock-free cache that CKComponentViewAttribute(SEL)
+     uses, resolving it on first use. Like that cache, it does not see setters swizzled after their first use.
+     */
+    IMP SetterIMP(Class cls, SEL setter);
+
+    template <typename T>
+    struct TypedAttributeTraits {
+      static id box(const T &value)
+      {
+        return BoxTypedAttributeValue(std::unique_ptr<const TypedAttributeValueBase>(new TypedAttributeValue<T>(value)));
+      }
+      static const T &unbox(id boxed)
+      {
+        return static_cast<const TypedAttributeValue<T> &>(UnboxTypedAttributeValue(boxed)).value;
+      }
+    };
+
+    /** CGColorRef is already an object, so it is stored as-is and compared with CFEqual (via -isEqual:). */
+    template <>
+    struct TypedAttributeTraits<CGColorRef> {
+      static id box(CGColorRef value) { return (__bridge id)value; }
+      static CGColorRef unbox(id boxed) { return (__bridge CGColorRef)boxed; }
+    };
+  }
+}
+
+/**
+ Creates an attribute/value pair that calls a setter taking a non-object argument directly through its IMP, instead of
+ boxing the value in an NSNumber or NSValue that must be unboxed through an NSInvocation when the view is mounted.
+ The attribute has the same identifier as CKComponentViewAttribute(setter), so the two are interchangeable for view
+ recycling purposes. T must be copyable and comparable with operator== (or be one of the CoreGraphics or UIKit structs
+ with an equality function).
+
+ @example {[UIView class], {CKComponentViewAttributeWithValue<CGFloat>(@selector(setAlpha:), 0.5)}}
+ */
+template <typename T>
+CKComponentViewAttributeValue CKComponentViewAttributeWithValue(SEL setter, T value)
+{
+  CKComponentViewAttribute attribute(std::string(sel_getName(setter)), ^(id view, id boxed){
+    typedef void (*SetterIMP)(id, SEL, T);
+    // Keyed on the runtime class, like CKComponentViewAttribute(SEL), so KVO subclasses get their own IMP.
+    SetterIMP imp = (SetterIMP)CK::Component::SetterIMP(object_getClass(view), setter);
+    imp(view, setter, CK::Component::TypedAttributeTraits<T>::unbox(boxed));
+  });
+  attribute.setter = setter;
+  return {std::move(attribute), CK::Component::TypedAttributeTraits<T>::box(value)};
+}
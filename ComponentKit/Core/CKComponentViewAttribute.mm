@@ -10,13 +10,19 @@
 
 #import "CKComponentViewAttribute.h"
 
+#import <algorithm>
+#import <atomic>
+#import <functional>
+#import <memory>
+#import <objc/message.h>
 #import <objc/runtime.h>
-#import <unordered_map>
 
-#import <ComponentKit/CKAssert.h>
 #import <ComponentKit/CKAssert.h>
 #import <ComponentKit/CKInternalHelpers.h>
 #import <ComponentKit/CKMacros.h>
+#import <ComponentKit/CKMutex.h>
+
+#import "CKInterner.h"
 
 /**
  * Helper macro for asserting that an @encode type is the same size as
@@ -47,175 +53,445 @@ namespace std {
   {
     std::size_t operator()(const SetterCacheKey &key) const
     {
-      NSUInteger subhashes[] = { [key.cls hash], std::hash<void *>()((void *)key.sel) };
+      NSUInteger subhashes[] = { std::hash<void *>()((__bridge void *)key.cls), std::hash<void *>()((void *)key.sel) };
       return CKIntegerArrayHash(subhashes, CK_ARRAY_COUNT(subhashes));
     }
   };
 }
 
+struct CachedSetter;
+typedef void (*SetterTrampoline)(id object, SEL setter, const CachedSetter &cachedSetter, id value);
+
+/**
+ Describes how to invoke a setter on instances of one class: the IMP to call, and a trampoline that unboxes the value
+ into the argument type the setter expects and calls the IMP directly.
+ */
 struct CachedSetter {
-  NSInvocation *invocation;
-  NSUInteger argumentSize;
+  IMP imp;
+  SetterTrampoline trampoline;
+  /** Set for struct arguments; keeps argumentType alive and is used to build invocations by the generic trampoline. */
+  NSMethodSignature *signature;
+  /** The encoding of the struct argument, without type qualifiers; NULL for objects and numbers. */
   const char *argumentType;
-
-  CachedSetter(NSInvocation *inv, NSUInteger argSize, const char *argType) : invocation(inv), argumentSize(argSize), argumentType(argType) {}
+  NSUInteger argumentSize;
 };
 
-static const CachedSetter &cachedSetterInvocation(id object, SEL setter)
+/** Objects need no unboxing, so they are sent as a regular message and always reach the current implementation. */
+static void objectTrampoline(id object, SEL setter, const CachedSetter &cs, id value)
+{
+  ((void (*)(id, SEL, id))objc_msgSend)(object, setter, value);
+}
+
+static void assertValueMatchesArgumentType(SEL setter, const CachedSetter &cs, id value)
+{
+  CKCAssert([value isKindOfClass:[NSValue class]] && strcmp([(NSValue *)value objCType], cs.argumentType) == 0,
+            @"%@ cannot be used as an argument to %@, which requires an NSValue of '%s'",
+            value, NSStringFromSelector(setter), cs.argumentType);
+}
+
+// We special case NSNumber because getting the correct byte width on both sides is either hard (e.g. NSInteger), or
+// impossible (e.g. CGFloat) on all architectures simultaneously. See
+// https://developer.apple.com/library/mac/documentation/Cocoa/Conceptual/ObjCRuntimeGuide/Articles/ocrtTypeEncodings.html
+// for more information on type encodings.
+#define CK_NUMBER_TRAMPOLINE(name, type, getter) \
+static void name(id object, SEL setter, const CachedSetter &cs, id value) \
+{ \
+  CKCAssert(value == nil || [value isKindOfClass:[NSNumber class]], \
+            @"%@ cannot be used as an argument to %@, which requires a number", value, NSStringFromSelector(setter)); \
+  ((void (*)(id, SEL, type))cs.imp)(object, setter, (type)[(NSNumber *)value getter]); \
+}
+
+CK_NUMBER_TRAMPOLINE(charTrampoline, char, charValue)
+CK_NUMBER_TRAMPOLINE(intTrampoline, int, intValue)
+CK_NUMBER_TRAMPOLINE(shortTrampoline, short, shortValue)
+// This is inconsistent, from the docs: "l is treated as a 32-bit quantity on 64-bit programs."
+CK_NUMBER_TRAMPOLINE(longTrampoline, int32_t, intValue)
+CK_NUMBER_TRAMPOLINE(longLongTrampoline, long long, longLongValue)
+CK_NUMBER_TRAMPOLINE(unsignedCharTrampoline, unsigned char, unsignedCharValue)
+CK_NUMBER_TRAMPOLINE(unsignedIntTrampoline, unsigned int, unsignedIntValue)
+CK_NUMBER_TRAMPOLINE(unsignedShortTrampoline, unsigned short, unsignedShortValue)
+// This is also inconsistent, and undocumented
+CK_NUMBER_TRAMPOLINE(unsignedLongTrampoline, uint32_t, unsignedIntValue)
+CK_NUMBER_TRAMPOLINE(unsignedLongLongTrampoline, unsigned long long, unsignedLongLongValue)
+CK_NUMBER_TRAMPOLINE(floatTrampoline, float, floatValue)
+CK_NUMBER_TRAMPOLINE(doubleTrampoline, double, doubleValue)
+CK_NUMBER_TRAMPOLINE(boolTrampoline, bool, boolValue)
+
+template <typename T>
+static void structTrampoline(id object, SEL setter, const CachedSetter &cs, id value)
 {
-  CKCAssertMainThread();
-  static auto *cachedInvocations = new std::unordered_map<SetterCacheKey, CachedSetter>();
-  SetterCacheKey key = {[object class], setter};
-  auto existingInvocation = cachedInvocations->find(key);
-  if (existingInvocation != cachedInvocations->end()) {
-    return existingInvocation->second;
+  assertValueMatchesArgumentType(setter, cs, value);
+  T structValue = {};
+  [(NSValue *)value getValue:&structValue];
+  ((void (*)(id, SEL, T))cs.imp)(object, setter, structValue);
+}
+
+/** Fallback for struct types without a specialized trampoline. The invocation is per-call, so it is thread-safe. */
+static void genericTrampoline(id object, SEL setter, const CachedSetter &cs, id value)
+{
+  assertValueMatchesArgumentType(setter, cs, value);
+  NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:cs.signature];
+  char buf[cs.argumentSize];
+  memset(buf, 0, cs.argumentSize);
+  [(NSValue *)value getValue:buf];
+  [invocation setArgument:buf atIndex:2];
+  [invocation setSelector:setter];
+  [invocation invokeWithTarget:object];
+}
+
+#define CK_NUMBER_TRAMPOLINE_CASE(encoding, type, trampoline) \
+    case encoding: \
+      CKCAssertSizeOfEquals(type, argumentType, @"'%s' is not the size of " #type, argumentType); \
+      return trampoline;
+
+static SetterTrampoline numberTrampolineForType(const char *argumentType)
+{
+  switch (*argumentType) {
+    CK_NUMBER_TRAMPOLINE_CASE('c', char, charTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('i', int, intTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('s', short, shortTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('l', int32_t, longTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('q', long long, longLongTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('C', unsigned char, unsignedCharTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('I', unsigned int, unsignedIntTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('S', unsigned short, unsignedShortTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('L', uint32_t, unsignedLongTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('Q', unsigned long long, unsignedLongLongTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('f', float, floatTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('d', double, doubleTrampoline)
+    CK_NUMBER_TRAMPOLINE_CASE('B', bool, boolTrampoline)
+    default:
+      // This should just be: 'v', ':', '?', none of which can be set from an attribute value.
+      return nullptr;
+  }
+}
+
+static CachedSetter resolveSetter(Class cls, SEL setter)
+{
+  NSMethodSignature *sig = [cls instanceMethodSignatureForSelector:setter];
+  CKCAssertNotNil(sig, @"%@ does not respond to %@", cls, NSStringFromSelector(setter));
+  CachedSetter cs = {
+    .imp = class_getMethodImplementation(cls, setter),
+    .trampoline = objectTrampoline,
+  };
+  if (sig == nil || [sig numberOfArguments] < 3) {
+    return cs;
   }
 
-  NSMethodSignature *sig = [object methodSignatureForSelector:setter];
-  // If the setter actually takes an NSValue id as the argument, we shouldn't unbox to the primitive type.
   const char *argumentType = [sig getArgumentTypeAtIndex:2];
-  if (strcmp(argumentType, @encode(id)) != 0) {
-    NSUInteger valueSize;
-    NSGetSizeAndAlignment(argumentType, &valueSize, NULL);
-    return cachedInvocations->emplace(key, CachedSetter([NSInvocation invocationWithMethodSignature:sig], valueSize, argumentType)).first->second;
+  // Skip type qualifiers like const ('r') which don't affect how the argument is passed.
+  while (*argumentType && strchr("rnNoORV", *argumentType)) {
+    argumentType++;
+  }
+  // Objects (including blocks), classes and pointers (e.g. CGColorRef) are passed as-is, not unboxed.
+  if (*argumentType == '\0' || strchr("@#^*", *argumentType)) {
+    return cs;
+  }
+
+  if (strlen(argumentType) == 1) {
+    SetterTrampoline numberTrampoline = numberTrampolineForType(argumentType);
+    CKCAssert(numberTrampoline != nullptr, @"Attribute values cannot be used as an argument to a selector requiring '%s'",
+              argumentType);
+    cs.trampoline = numberTrampoline ?: objectTrampoline;
+    return cs;
+  }
+
+  cs.signature = sig;
+  cs.argumentType = argumentType;
+  if (strcmp(argumentType, @encode(CGRect)) == 0) {
+    cs.trampoline = structTrampoline<CGRect>;
+  } else if (strcmp(argumentType, @encode(CGPoint)) == 0) {
+    cs.trampoline = structTrampoline<CGPoint>;
+  } else if (strcmp(argumentType, @encode(CGSize)) == 0) {
+    cs.trampoline = structTrampoline<CGSize>;
+  } else if (strcmp(argumentType, @encode(UIEdgeInsets)) == 0) {
+    cs.trampoline = structTrampoline<UIEdgeInsets>;
+  } else if (strcmp(argumentType, @encode(CGAffineTransform)) == 0) {
+    cs.trampoline = structTrampoline<CGAffineTransform>;
+  } else if (strcmp(argumentType, @encode(CATransform3D)) == 0) {
+    cs.trampoline = structTrampoline<CATransform3D>;
+  } else if (strcmp(argumentType, @encode(NSRange)) == 0) {
+    cs.trampoline = structTrampoline<NSRange>;
   } else {
-    return cachedInvocations->emplace(key, CachedSetter(nil, 0, nullptr)).first->second;
+    cs.trampoline = genericTrampoline;
+    NSGetSizeAndAlignment(argumentType, &cs.argumentSize, NULL);
   }
+  return cs;
 }
 
-static void performSetter(id object, SEL setter, id value)
+/** Immutable once published; nodes are never freed, so references to their setters stay valid. */
+struct SetterCacheNode {
+  const SetterCacheKey key;
+  const CachedSetter setter;
+  const SetterCacheNode *const next;
+};
+
+static const size_t kSetterCacheBucketCount = 512;
+static std::atomic<const SetterCacheNode *> setterCacheBuckets[kSetterCacheBucketCount];
+
+static const SetterCacheNode *findSetterCacheNode(const SetterCacheNode *node, const SetterCacheKey &key)
 {
-  if ([value isKindOfClass:[NSValue class]]) {
-    const CachedSetter &set = cachedSetterInvocation(object, setter);
-    if (set.invocation) {
-      if ([value isKindOfClass:[NSNumber class]]) {
-        // We special case NSNumber because getting the correct byte width on both sides
-        // is either hard (e.g. NSInteger), or impossible (e.g. CGFloat) on all architectures
-        // simultaneously.
-        // See https://developer.apple.com/library/mac/documentation/Cocoa/Conceptual/ObjCRuntimeGuide/Articles/ocrtTypeEncodings.html
-        // for more information on type encodings
-        if (set.argumentType == nullptr || strlen(set.argumentType) != 1) {
-          CKCAssert(NO, @"NSNumber: %@ cannot be used as an argument to a selector requiring '%s'", value, set.argumentType ?: "NULL");
-          return;
-        }
-        NSNumber *numValue = (NSNumber *)value;
-        switch (*set.argumentType) {
-          case 'c': {
-            CKCAssertSizeOfEquals(char, set.argumentType, @"");
-            char charValue = [numValue charValue];
-            [set.invocation setArgument:&charValue atIndex:2];
-            break;
-          }
-          case 'i': {
-            CKCAssertSizeOfEquals(int, set.argumentType, @"");
-            int intValue = [numValue intValue];
-            [set.invocation setArgument:&intValue atIndex:2];
-            break;
-          }
-          case 's': {
-            CKCAssertSizeOfEquals(short, set.argumentType, @"");
-            short shortValue = [numValue shortValue];
-            [set.invocation setArgument:&shortValue atIndex:2];
-            break;
-          }
-          case 'l': {
-            // This is inconsistent, from the docs: "l is treated as a 32-bit quantity on 64-bit programs."
-            CKCAssertSizeOfEquals(int32_t, set.argumentType, @"");
-            int32_t longValue = [numValue intValue];
-            [set.invocation setArgument:&longValue atIndex:2];
-            break;
-          }
-          case 'q': {
-            CKCAssertSizeOfEquals(long long, set.argumentType, @"");
-            long long longLongValue = [numValue longLongValue];
-            [set.invocation setArgument:&longLongValue atIndex:2];
-            break;
-          }
-          case 'C': {
-            CKCAssertSizeOfEquals(unsigned char, set.argumentType, @"");
-            unsigned char uCharValue = [numValue unsignedCharValue];
-            [set.invocation setArgument:&uCharValue atIndex:2];
-            break;
-          }
-          case 'I': {
-            CKCAssertSizeOfEquals(unsigned int, set.argumentType, @"");
-            unsigned int uIntValue = [numValue unsignedIntValue];
-            [set.invocation setArgument:&uIntValue atIndex:2];
-            break;
-          }
-          case 'S': {
-            CKCAssertSizeOfEquals(unsigned short, set.argumentType, @"");
-            unsigned short uShortValue = [numValue unsignedShortValue];
-            [set.invocation setArgument:&uShortValue atIndex:2];
-            break;
-          }
-          case 'L': {
-            // This is also inconsistent, and undocumented
-            CKCAssertSizeOfEquals(uint32_t, set.argumentType, @"");
-            uint32_t uLongValue = [numValue unsignedIntValue];
-            [set.invocation setArgument:&uLongValue atIndex:2];
-            break;
-          }
-          case 'Q': {
-            CKCAssertSizeOfEquals(unsigned long long, set.argumentType, @"");
-            unsigned long long uLongLongValue = [numValue unsignedLongLongValue];
-            [set.invocation setArgument:&uLongLongValue atIndex:2];
-            break;
-          }
-          case 'f': {
-            CKCAssertSizeOfEquals(float, set.argumentType, @"");
-            float floatValue = [numValue floatValue];
-            [set.invocation setArgument:&floatValue atIndex:2];
-            break;
-          }
-          case 'd': {
-            CKCAssertSizeOfEquals(double, set.argumentType, @"");
-            double doubleValue = [numValue doubleValue];
-            [set.invocation setArgument:&doubleValue atIndex:2];
-            break;
-          }
-          case 'B': {
-            CKCAssertSizeOfEquals(BOOL, set.argumentType, @"");
-            BOOL boolValue = [numValue boolValue];
-            [set.invocation setArgument:&boolValue atIndex:2];
-            break;
-          }
-          default:
-            // This should just be: 'v', '*', '@', '#', ':', '?', none of which should be boxed as NSNumber
-            CKCAssert(NO, @"NSNumber: %@ cannot be used as an argument to a selector requiring '%s'", value, set.argumentType);
-            return;
-        }
-      } else {
-        char buf[set.argumentSize];
-        [value getValue:buf];
-        [set.invocation setArgument:buf atIndex:2];
-      }
-      [set.invocation setSelector:setter];
-      [set.invocation invokeWithTarget:object];
-      return;
+  for (; node != nullptr; node = node->next) {
+    if (node->key == key) {
+      return node;
     }
   }
+  return nullptr;
+}
+
+/**
+ A grow-only hash table: each bucket is a list of nodes that is only ever prepended to, so reads are lock-free and each
+ entry costs a single allocation. Writers are serialized so that a setter is only resolved once.
+ */
+static const CachedSetter &cachedSetter(Class cls, SEL setter)
+{
+  const SetterCacheKey key = {cls, setter};
+  const size_t bucketIndex = std::hash<SetterCacheKey>()(key) % kSetterCacheBucketCount;
+  std::atomic<const SetterCacheNode *> &bucket = setterCacheBuckets[bucketIndex];
+  if (const SetterCacheNode *node = findSetterCacheNode(bucket.load(std::memory_order_acquire), key)) {
+    return node->setter;
+  }
+
+  static CK::StaticMutex lock = CK_MUTEX_INITIALIZER; // serializes writers of setterCacheBuckets
+  CK::StaticMutexLocker l(lock);
+  const SetterCacheNode *head = bucket.load(std::memory_order_acquire);
+  if (const SetterCacheNode *node = findSetterCacheNode(head, key)) {
+    return node->setter; // Another thread resolved it while we were waiting for the lock.
+  }
+  const SetterCacheNode *node = new SetterCacheNode({key, resolveSetter(cls, setter), head});
+  bucket.store(node, std::memory_order_release);
+  return node->setter;
+}
+
+static void performSetter(id object, SEL setter, id value)
+{
+  // Key on the object's actual class (not -class) so that we call the IMP that messaging would have reached, even for
+  // dynamically subclassed objects (e.g. KVO).
+  const CachedSetter &cs = cachedSetter(object_getClass(object), setter);
+  cs.trampoline(object, setter, cs, value);
+}
+
+void CKComponentViewAttributePrepareSetter(Class viewClass, SEL setter)
+{
+  (void)cachedSetter(viewClass, setter);
+}
+
+IMP CK::Component::SetterIMP(Class cls, SEL setter)
+{
+  return cachedSetter(cls, setter).imp;
+}
+
+@interface CKTypedAttributeValueBox : NSObject
+{
+@public
+  std::unique_ptr<const CK::Component::TypedAttributeValueBase> _value;
+}
+@end
+
+@implementation CKTypedAttributeValueBox
+
+- (BOOL)isEqual:(id)object
+{
+  if (self == object) {
+    return YES;
+  }
+  if (![object isKindOfClass:[CKTypedAttributeValueBox class]]) {
+    return NO;
+  }
+  return _value->isEqual(*((CKTypedAttributeValueBox *)object)->_value);
+}
+
+- (NSUInteger)hash
+{
+  return _value->hash();
+}
+
+@end
 
-  // ARC is worried that the selector might have a return value it doesn't know about, or be annotated with ns_consumed.
-  // Neither is typically the case for setters, so ignore the warning.
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
-  [object performSelector:setter withObject:value];
-#pragma clang diagnostic pop
+id CK::Component::BoxTypedAttributeValue(std::unique_ptr<const TypedAttributeValueBase> value)
+{
+  CKTypedAttributeValueBox *box = [[CKTypedAttributeValueBox alloc] init];
+  box->_value = std::move(value);
+  return box;
+}
+
+const CK::Component::TypedAttributeValueBase &CK::Component::UnboxTypedAttributeValue(id box)
+{
+  CKCAssert([box isKindOfClass:[CKTypedAttributeValueBox class]], @"Expected a typed attribute value but got %@", box);
+  return *((CKTypedAttributeValueBox *)box)->_value;
 }
 
 CKComponentViewAttribute::CKComponentViewAttribute(SEL setter) :
 identifier(sel_getName(setter)),
+internedIdentifier(internIdentifier(identifier)),
 applicator(^(UIView *view, id value){
   performSetter(view, setter, value);
-}) {}
+}),
+setter(setter) {}
+
+int32_t CKComponentViewAttribute::internIdentifier(const std::string &ident)
+{
+  static auto *interner = new CK::Interner<std::string>();
+  return interner->intern(ident);
+}
 
 // Explicit destructor to prevent inlining, reduce code size. See D1814602.
 CKComponentViewAttribute::~CKComponentViewAttribute() {}
 
+#pragma mark - CKViewComponentAttributeValueMap
+
+CKViewComponentAttributeValueMap::CKViewComponentAttributeValueMap(std::initializer_list<value_type> values)
+: CKViewComponentAttributeValueMap()
+{
+  if (values.size() > _capacity) {
+    reserve((uint32_t)values.size());
+  }
+  insert(values.begin(), values.end());
+}
+
+CKViewComponentAttributeValueMap::CKViewComponentAttributeValueMap(const CKViewComponentAttributeValueMap &other)
+: CKViewComponentAttributeValueMap()
+{
+  *this = other;
+}
+
+CKViewComponentAttributeValueMap::CKViewComponentAttributeValueMap(CKViewComponentAttributeValueMap &&other)
+: CKViewComponentAttributeValueMap()
+{
+  moveFrom(std::move(other));
+}
+
+CKViewComponentAttributeValueMap &CKViewComponentAttributeValueMap::operator=(const CKViewComponentAttributeValueMap &other)
+{
+  if (this != &other) {
+    clear();
+    if (other._size > _capacity) {
+      reserve(other._size);
+    }
+    // other is already sorted and free of duplicates, so copy it as is.
+    std::uninitialized_copy(other.begin(), other.end(), _elements);
+    _size = other._size;
+  }
+  return *this;
+}
+
+CKViewComponentAttributeValueMap &CKViewComponentAttributeValueMap::operator=(CKViewComponentAttributeValueMap &&other)
+{
+  if (this != &other) {
+    clear();
+    moveFrom(std::move(other));
+  }
+  return *this;
+}
+
+CKViewComponentAttributeValueMap::~CKViewComponentAttributeValueMap()
+{
+  clear();
+}
+
+CKViewComponentAttributeValueMap::const_iterator CKViewComponentAttributeValueMap::find(const key_type &key) const
+{
+  value_type *it = lowerBound(key.internedIdentifier);
+  return (it != end() && it->first.internedIdentifier == key.internedIdentifier) ? it : end();
+}
+
+std::pair<CKViewComponentAttributeValueMap::const_iterator, bool>
+CKViewComponentAttributeValueMap::insert(const value_type &value)
+{
+  return insert(value_type(value));
+}
+
+std::pair<CKViewComponentAttributeValueMap::const_iterator, bool>
+CKViewComponentAttributeValueMap::insert(value_type &&value)
+{
+  value_type *position = lowerBound(value.first.internedIdentifier);
+  if (position != end() && position->first.internedIdentifier == value.first.internedIdentifier) {
+    return {position, false};
+  }
+  const size_t index = position - _elements;
+  if (_size == _capacity) {
+    reserve(_capacity * 2);
+    position = _elements + index;
+  }
+  value_type *last = _elements + _size;
+  if (position == last) {
+    new (last) value_type(std::move(value));
+  } else {
+    // Shift the tail up by one: the last element moves into uninitialized storage, the rest are move-assigned.
+    new (last) value_type(std::move(*(last - 1)));
+    std::move_backward(position, last - 1, last);
+    *position = std::move(value);
+  }
+  _size++;
+  return {position, true};
+}
+
+id &CKViewComponentAttributeValueMap::operator[](const key_type &key)
+{
+  const auto result = insert(value_type(key, nil));
+  return const_cast<value_type *>(result.first)->second;
+}
+
+CKViewComponentAttributeValueMap::value_type *CKViewComponentAttributeValueMap::lowerBound(int32_t internedIdentifier) const
+{
+  return std::lower_bound(_elements, _elements + _size, internedIdentifier, [](const value_type &elem, int32_t ident) {
+    return elem.first.internedIdentifier < ident;
+  });
+}
+
+void CKViewComponentAttributeValueMap::reserve(uint32_t capacity)
+{
+  value_type *elements = static_cast<value_type *>(::operator new(sizeof(value_type) * capacity));
+  for (uint32_t i = 0; i < _size; i++) {
+    new (elements + i) value_type(std::move(_elements[i]));
+    _elements[i].~value_type();
+  }
+  if (!isInline()) {
+    ::operator delete(_elements);
+  }
+  _elements = elements;
+  _capacity = capacity;
+}
+
+/** Destroys all elements and returns to inline storage. */
+void CKViewComponentAttributeValueMap::clear()
+{
+  for (uint32_t i = 0; i < _size; i++) {
+    _elements[i].~value_type();
+  }
+  if (!isInline()) {
+    ::operator delete(_elements);
+  }
+  _elements = inlineElements();
+  _size = 0;
+  _capacity = kInlineCapacity;
+}
+
+/** Expects this map to be empty and inline; leaves other empty and inline. */
+void CKViewComponentAttributeValueMap::moveFrom(CKViewComponentAttributeValueMap &&other)
+{
+  if (other.isInline()) {
+    for (uint32_t i = 0; i < other._size; i++) {
+      new (_elements + i) value_type(std::move(other._elements[i]));
+    }
+    _size = other._size;
+    other.clear();
+  } else {
+    _elements = other._elements;
+    _size = other._size;
+    _capacity = other._capacity;
+    other._elements = other.inlineElements();
+    other._size = 0;
+    other._capacity = kInlineCapacity;
+  }
+}
+
 CKComponentViewAttribute CKComponentViewAttribute::LayerAttribute(SEL setter)
 {
-  return CKComponentViewAttribute(std::string("layer") + sel_getName(setter), ^(UIView *view, id value){
+  CKComponentViewAttribute attribute(std::string("layer") + sel_getName(setter), ^(UIView *view, id value){
     performSetter(view.layer, setter, value);
   });
+  attribute.setter = setter;
+  attribute.setterTargetsLayer = true;
+  return attribute;
 }
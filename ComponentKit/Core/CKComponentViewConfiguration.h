@@ -69,15 +69,23 @@ struct CKComponentViewClass {
   /** Invoked by the infrastructure to determine if this will create a view or not. */
   BOOL hasView() const;
 
-  bool operator==(const CKComponentViewClass &other) const { return other.identifier == identifier; }
-  bool operator!=(const CKComponentViewClass &other) const { return other.identifier != identifier; }
+  bool operator==(const CKComponentViewClass &other) const { return other.internedIdentifier == internedIdentifier; }
+  bool operator!=(const CKComponentViewClass &other) const { return other.internedIdentifier != internedIdentifier; }
 
   const std::string &getIdentifier() const { return identifier; }
 
+  /** A small integer uniquely identifying getIdentifier() for the lifetime of the process; cheap to compare and hash. */
+  int32_t getInternedIdentifier() const { return internedIdentifier; }
+
+  /** The class of the views, or Nil if they are created by a factory. */
+  Class getViewClass() const { return viewClass; }
+
   /** FB specific internal extension for supporting deprecated API. */
   friend class CKComponentViewClassFBInternal;
 private:
   std::string identifier;
+  int32_t internedIdentifier;
+  Class viewClass = Nil;
   UIView *(^factory)(void);
   CKComponentViewReuseBlock didEnterReusePool;
   CKComponentViewReuseBlock willLeaveReusePool;
@@ -89,7 +97,7 @@ namespace std {
   {
     size_t operator()(const CKComponentViewClass &cl) const
     {
-      return hash<std::string>()(cl.getIdentifier());
+      return hash<int32_t>()(cl.getInternedIdentifier());
     }
   };
 }
@@ -100,6 +108,10 @@ namespace std {
 
  {[UIView class]}
  {[UIView class], {{@selector(setBackgroundColor:), [UIColor redColor]}, {@selector(setAlpha:), @0.5}}}
+
+ Configurations with equal view classes and attribute values (and no accessibility context) share one immutable
+ representation, so many components built from the same constant configuration cost a single attribute map and
+ compare equal with a pointer comparison.
  */
 struct CKComponentViewConfiguration {
 
@@ -128,6 +140,12 @@ private:
   };
 
   static std::shared_ptr<const Repr> singletonViewConfiguration();
+  static std::shared_ptr<const Repr> internedRepr(CKComponentViewClass &&cls,
+                                                  CKViewComponentAttributeValueMap &&attrs,
+                                                  CKComponentAccessibilityContext &&accessibilityCtx);
+  static std::shared_ptr<const Repr> newRepr(CKComponentViewClass &&cls,
+                                             CKViewComponentAttributeValueMap &&attrs,
+                                             CKComponentAccessibilityContext &&accessibilityCtx);
   std::shared_ptr<const Repr> rep; // const is important for the singletonViewConfiguration optimization.
 
   friend class CK::Component::ViewReusePoolMap;    // uses attributeShape
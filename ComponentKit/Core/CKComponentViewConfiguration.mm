@@ -10,16 +10,29 @@
 
 #import "CKComponentViewConfiguration.h"
 
+#import <algorithm>
 #import <objc/runtime.h>
+#import <unordered_map>
 
 #import <ComponentKit/CKAssert.h>
+#import <ComponentKit/CKMacros.h>
+#import <ComponentKit/CKMutex.h>
 
 #import "CKInternalHelpers.h"
+#import "CKInterner.h"
 
-CKComponentViewClass::CKComponentViewClass() : factory(nil) {}
+static int32_t internViewClassIdentifier(const std::string &identifier)
+{
+  static auto *interner = new CK::Interner<std::string>();
+  return interner->intern(identifier);
+}
+
+CKComponentViewClass::CKComponentViewClass() : internedIdentifier(internViewClassIdentifier(identifier)), factory(nil) {}
 
 CKComponentViewClass::CKComponentViewClass(Class viewClass) :
 identifier(class_getName(viewClass)),
+internedIdentifier(internViewClassIdentifier(identifier)),
+viewClass(viewClass),
 factory(^{return [[viewClass alloc] init];}) {}
 
 static CKComponentViewReuseBlock blockFromSEL(SEL sel)
@@ -35,6 +48,8 @@ static CKComponentViewReuseBlock blockFromSEL(SEL sel)
 
 CKComponentViewClass::CKComponentViewClass(Class viewClass, SEL enter, SEL leave) :
 identifier(std::string(class_getName(viewClass)) + "-" + sel_getName(enter) + "-" + sel_getName(leave)),
+internedIdentifier(internViewClassIdentifier(identifier)),
+viewClass(viewClass),
 factory(^{return [[viewClass alloc] init];}),
 didEnterReusePool(blockFromSEL(enter)),
 willLeaveReusePool(blockFromSEL(leave)) {}
@@ -42,7 +57,9 @@ willLeaveReusePool(blockFromSEL(leave)) {}
 CKComponentViewClass::CKComponentViewClass(UIView *(*fact)(void),
                                            void (^enter)(UIView *),
                                            void (^leave)(UIView *))
-: identifier(CKStringFromPointer((const void *)fact)), factory(^UIView*(void) {return fact();}), didEnterReusePool(enter), willLeaveReusePool(leave)
+: identifier(CKStringFromPointer((const void *)fact)),
+internedIdentifier(internViewClassIdentifier(identifier)),
+factory(^UIView*(void) {return fact();}), didEnterReusePool(enter), willLeaveReusePool(leave)
 {
 }
 
@@ -50,7 +67,7 @@ CKComponentViewClass::CKComponentViewClass(const std::string &i,
                                            UIView *(^fact)(void),
                                            void (^enter)(UIView *),
                                            void (^leave)(UIView *))
-: identifier(i), factory(fact), didEnterReusePool(enter), willLeaveReusePool(leave)
+: identifier(i), internedIdentifier(internViewClassIdentifier(identifier)), factory(fact), didEnterReusePool(enter), willLeaveReusePool(leave)
 {
 #if DEBUG
   CKCAssertNil(objc_getClass(i.c_str()), @"You may not use a class name as the identifier; it would conflict with "
@@ -76,19 +93,145 @@ CKComponentViewConfiguration::CKComponentViewConfiguration(
     CKViewComponentAttributeValueMap &&attrs)
 : CKComponentViewConfiguration(std::move(cls), std::move(attrs), {}) {}
 
-CKComponentViewConfiguration::CKComponentViewConfiguration(CKComponentViewClass &&cls,
-                                                           CKViewComponentAttributeValueMap &&attrs,
-                                                           CKComponentAccessibilityContext &&accessibilityCtx)
+/** Attribute maps are sorted by identifier, so equal maps have equal elements at every position. */
+static bool attributesAreEqual(const CKViewComponentAttributeValueMap &a, const CKViewComponentAttributeValueMap &b)
+{
+  return a.size() == b.size()
+  && std::equal(a.begin(), a.end(), b.begin(), [](const CKComponentViewAttributeValue &x,
+                                                 const CKComponentViewAttributeValue &y) {
+    return x.first == y.first && CKObjectIsEqual(x.second, y.second);
+  });
+}
+
+static size_t attributesHash(const CKComponentViewClass &cls, const CKViewComponentAttributeValueMap &attrs)
+{
+  size_t hash = std::hash<CKComponentViewClass>()(cls);
+  for (const auto &it : attrs) {
+    NSUInteger subhashes[] = { std::hash<CKComponentViewAttribute>()(it.first), [it.second hash] };
+    hash ^= CKIntegerArrayHash(subhashes, CK_ARRAY_COUNT(subhashes));
+  }
+  return hash;
+}
+
+/**
+ Accessibility contexts are compared by evaluating their lazy text blocks, which must only happen when VoiceOver is on,
+ so only configurations without one are interned.
+ */
+static bool accessibilityContextIsEmpty(const CKComponentAccessibilityContext &ctx)
+{
+  return ctx.isAccessibilityElement == nil
+  && ctx.accessibilityIdentifier == nil
+  && !ctx.accessibilityLabel.hasText()
+  && ctx.accessibilityComponentAction == NULL;
+}
+
+/** Components are built on several threads at once, so the table is split to keep them from contending on one lock. */
+static const size_t kInternedReprShardCount = 16;
+
+/**
+ Hash-conses Reprs: a configuration whose view class and attribute values are equal to those of a live configuration
+ shares its Repr, including the attribute map. The table only holds weak references, so a Repr is freed when the last
+ component using it is; expired entries in a shard are swept whenever it has doubled in size since its last sweep.
+
+ The hash is computed and new Reprs are built without holding a lock; only the shard the hash selects is locked, and
+ only while candidates are compared.
+
+ Attributes are considered equal when their identifiers and values are, which is the same rule AttributeApplicator
+ uses to decide that an attribute need not be re-applied to a recycled view.
+ */
+std::shared_ptr<const CKComponentViewConfiguration::Repr>
+CKComponentViewConfiguration::internedRepr(CKComponentViewClass &&cls,
+                                           CKViewComponentAttributeValueMap &&attrs,
+                                           CKComponentAccessibilityContext &&accessibilityCtx)
+{
+  if (!accessibilityContextIsEmpty(accessibilityCtx)) {
+    return newRepr(std::move(cls), std::move(attrs), std::move(accessibilityCtx));
+  }
+
+  struct Shard {
+    CK::Mutex lock; // protects table and sweepThreshold
+    std::unordered_multimap<size_t, std::weak_ptr<const Repr>> table;
+    size_t sweepThreshold = 64;
+  };
+  static auto *shards = new Shard[kInternedReprShardCount];
+
+  const size_t hash = attributesHash(cls, attrs);
+  Shard &shard = shards[hash % kInternedReprShardCount];
+  // Must be called with shard.lock held.
+  const auto findExisting = [&](const CKComponentViewClass &c,
+                                const CKViewComponentAttributeValueMap &a) -> std::shared_ptr<const Repr> {
+    const auto range = shard.table.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      std::shared_ptr<const Repr> existing = it->second.lock();
+      if (existing && existing->viewClass == c && attributesAreEqual(*existing->attributes, a)) {
+        return existing;
+      }
+    }
+    return std::shared_ptr<const Repr>();
+  };
+
+  {
+    CK::MutexLocker l(shard.lock);
+    if (std::shared_ptr<const Repr> existing = findExisting(cls, attrs)) {
+      return existing;
+    }
+  }
+
+  // Build the Repr outside the lock; if another thread interned an equal one in the meantime, use that instead.
+  std::shared_ptr<const Repr> repr = newRepr(std::move(cls), std::move(attrs), std::move(accessibilityCtx));
+  CK::MutexLocker l(shard.lock);
+  if (std::shared_ptr<const Repr> existing = findExisting(repr->viewClass, *repr->attributes)) {
+    return existing;
+  }
+  if (shard.table.size() >= shard.sweepThreshold) {
+    for (auto it = shard.table.begin(); it != shard.table.end();) {
+      it = it->second.expired() ? shard.table.erase(it) : std::next(it);
+    }
+    shard.sweepThreshold = std::max<size_t>(64, shard.table.size() * 2);
+  }
+  shard.table.emplace(hash, repr);
+  return repr;
+}
+
+/**
+ Resolves the setters of the attributes now, on the thread building components, instead of during the first mount.
+ Setters the class does not implement are left for the mount to assert on, since a configuration may never be mounted.
+ */
+static void prepareSetters(const CKComponentViewClass &cls, const CKViewComponentAttributeValueMap &attrs)
+{
+  Class viewClass = cls.getViewClass();
+  if (viewClass == Nil) {
+    return;
+  }
+  for (const auto &it : attrs) {
+    const SEL setter = it.first.setter;
+    Class targetClass = it.first.setterTargetsLayer ? [viewClass layerClass] : viewClass;
+    if (setter && [targetClass instancesRespondToSelector:setter]) {
+      CKComponentViewAttributePrepareSetter(targetClass, setter);
+    }
+  }
+}
+
+std::shared_ptr<const CKComponentViewConfiguration::Repr>
+CKComponentViewConfiguration::newRepr(CKComponentViewClass &&cls,
+                                      CKViewComponentAttributeValueMap &&attrs,
+                                      CKComponentAccessibilityContext &&accessibilityCtx)
 {
   // Need to use attrs before we move it below.
+  prepareSetters(cls, attrs);
   CK::Component::PersistentAttributeShape attributeShape(attrs);
-  rep.reset(new Repr({
+  return std::shared_ptr<const Repr>(new Repr({
     .viewClass = std::move(cls),
     .attributes = std::make_shared<CKViewComponentAttributeValueMap>(std::move(attrs)),
     .accessibilityContext = std::move(accessibilityCtx),
     .attributeShape = std::move(attributeShape)}));
 }
 
+CKComponentViewConfiguration::CKComponentViewConfiguration(CKComponentViewClass &&cls,
+                                                           CKViewComponentAttributeValueMap &&attrs,
+                                                           CKComponentAccessibilityContext &&accessibilityCtx)
+: rep(internedRepr(std::move(cls), std::move(attrs), std::move(accessibilityCtx))) {}
+
 // Constructors and destructors are defined out-of-line to prevent code bloat.
 CKComponentViewConfiguration::~CKComponentViewConfiguration() {}
 
@@ -104,18 +247,7 @@ bool CKComponentViewConfiguration::operator==(const CKComponentViewConfiguration
   }
 
   const auto &otherAttributes = other.rep->attributes;
-  if (otherAttributes == rep->attributes) {
-    return true;
-  } else if (otherAttributes->size() == rep->attributes->size()) {
-    return std::find_if(rep->attributes->begin(),
-                        rep->attributes->end(),
-                        [&](std::pair<const CKComponentViewAttribute &, id> elem) {
-                          const auto otherElem = otherAttributes->find(elem.first);
-                          return otherElem == otherAttributes->end() || !CKObjectIsEqual(otherElem->second, elem.second);
-                        }) == rep->attributes->end();
-  } else {
-    return false;
-  }
+  return otherAttributes == rep->attributes || attributesAreEqual(*rep->attributes, *otherAttributes);
 }
 
 const CKComponentViewClass &CKComponentViewConfiguration::viewClass() const
@@ -18,6 +18,8 @@
 #import <UIKit/UIKit.h>
 
 #import <ComponentKit/CKComponentViewAttribute.h>
+#import <ComponentKit/CKInternalHelpers.h>
+#import <ComponentKit/CKMacros.h>
 
 @class CKComponent;
 class CKComponentViewConfiguration;
@@ -41,7 +43,7 @@ namespace CK {
       friend struct ::std::hash<PersistentAttributeShape>;
       /**
        This is a int32_t since they are compared on the main thread where we want optimal performance.
-       Behind the scenes, these are looked up/created using a map of unordered_set<string> -> int32_t.
+       Behind the scenes, these are interned from the sorted interned identifiers of the persistent attributes.
        */
       int32_t _identifier;
       static int32_t computeIdentifier(const CKViewComponentAttributeValueMap &attributes);
@@ -52,11 +54,12 @@ namespace CK {
        Class of the CKComponent. Even if two different CKComponent classes have the same viewClassIdentifier, we don't
        recycle views between them.
        */
-      Class componentClass;
+      Class __unsafe_unretained componentClass;
       /**
-       This differentiates components that have the same componentClass but different view types.
+       This differentiates components that have the same componentClass but different view types. It is the interned
+       identifier of the CKComponentViewClass, so comparing and hashing keys never touches a string.
        */
-      std::string viewClassIdentifier;
+      int32_t viewClassIdentifier;
       /**
        To recycle a view, its attribute identifiers must exactly match. Otherwise if you had an initial tree A:
        <View backgroundColor=blue />
@@ -91,9 +94,12 @@ namespace std {
   {
     size_t operator()(const CK::Component::ViewKey &k) const
     {
-      return [k.componentClass hash]
-              ^ hash<std::string>()(k.viewClassIdentifier)
-              ^ std::hash<CK::Component::PersistentAttributeShape>()(k.attributeShape);
+      NSUInteger subhashes[] = {
+        hash<void *>()((__bridge void *)k.componentClass),
+        hash<int32_t>()(k.viewClassIdentifier),
+        hash<CK::Component::PersistentAttributeShape>()(k.attributeShape),
+      };
+      return CKIntegerArrayHash(subhashes, CK_ARRAY_COUNT(subhashes));
     }
   };
 }
@@ -102,18 +108,63 @@ class CKComponentViewClass;
 
 namespace CK {
   namespace Component {
+    /** Process-wide counters for one ViewKey, aggregated over all containers. Main thread only. */
+    struct ViewKeyStatistics {
+      /** Views that had to be created while mounting because the container's pool had none left for the key. */
+      NSUInteger missCount;
+      /** The most views for the key that were vended into a single container in one mounting pass. */
+      NSUInteger peakVendedCount;
+      /** Views taken from the SharedViewReusePool rather than created when a container's pool had none left. */
+      NSUInteger sharedPoolHitCount;
+    };
+
+    /**
+     An optional process-wide pool of hidden views per ViewKey, shared by all containers. It is disabled by default,
+     in which case views that a container no longer needs stay hidden in that container's pool.
+
+     When enabled, a container's pool hands the views it hid during a mounting pass to the shared pool (up to the cap for
+     their key; any excess stays hidden in the container as before), removing them from the container. A container that
+     runs out of views for a key takes one from the shared pool before creating a new one. This lowers the number of
+     views alive at once and how many are created when cells with different content scroll by.
+
+     Views are only moved between containers while hidden, and their didEnterReusePool/willLeaveReusePool callbacks
+     still fire exactly once per hide/unhide. Main thread only.
+     */
+    class SharedViewReusePool {
+    public:
+      /** Sets the most views kept per ViewKey. 0, the default, disables sharing and releases any pooled views. */
+      static void setMaximumViewsPerKey(NSUInteger maximumViewsPerKey);
+      static NSUInteger maximumViewsPerKey();
+      /** The number of views currently held across all keys. */
+      static NSUInteger viewCount();
+    };
+
     class ViewReusePool {
     public:
-      ViewReusePool() : position(pool.begin()) {};
+      ViewReusePool() : position(pool.begin()), key(nullptr), statistics(nullptr) {};
 
-      /** Unhides all views vended so far; hides others. Resets position to begin(). */
-      void reset();
+      /**
+       Unhides all views vended so far; hides others, handing them to the SharedViewReusePool if it is enabled.
+       Resets position to begin().
+       */
+      void reset(UIView *container);
 
       UIView *viewForClass(const CKComponentViewClass &viewClass, UIView *container);
+
+      /** Creates hidden views until the pool holds at least count views. */
+      void prewarm(const CKComponentViewClass &viewClass, UIView *container, NSUInteger count);
     private:
+      friend class ViewReusePoolMap;
+
+      UIView *createView(const CKComponentViewClass &viewClass, UIView *container);
+
       std::vector<UIView *> pool;
       /** Points to the next view in pool that has *not* yet been vended. */
       std::vector<UIView *>::iterator position;
+      /** Points to this pool's key in the owning ViewReusePoolMap; set by ViewReusePoolMap. */
+      const ViewKey *key;
+      /** Points into the process-wide statistics for this pool's key; set by ViewReusePoolMap. */
+      ViewKeyStatistics *statistics;
 
       ViewReusePool(const ViewReusePool&) = delete;
       ViewReusePool &operator=(const ViewReusePool&) = delete;
@@ -128,7 +179,32 @@ namespace CK {
       void reset(UIView *container);
 
       UIView *viewForConfiguration(Class componentClass, const CKComponentViewConfiguration &config, UIView *container);
+
+      /**
+       Creates views for the configuration ahead of time, so that a later mount into container recycles them instead of
+       creating and adding them mid-mount. Intended to be called when the main thread is idle, e.g. before a new kind of
+       cell scrolls in. Prewarmed views stay hidden until vended.
+
+       Must not be called while a ViewManager for container is alive. Components must have mounted in container before,
+       or ViewReuseUtilities::mountingInRootView() must have been called on it.
+
+       @param count The number of views the container's pool should hold for the configuration's ViewKey.
+       */
+      void prewarm(Class componentClass, const CKComponentViewConfiguration &config, UIView *container, NSUInteger count);
+
+      /**
+       Like prewarm() above, with count set to the most views for the configuration's ViewKey that were vended into any
+       single container in one pass (but at least one); see statistics().
+       */
+      void prewarm(Class componentClass, const CKComponentViewConfiguration &config, UIView *container);
+
+      /** Counters for each ViewKey that has been used since launch. Main thread only. */
+      static std::unordered_map<ViewKey, ViewKeyStatistics> statistics();
+      /** Zeroes all counters. Main thread only. */
+      static void resetStatistics();
     private:
+      ViewReusePool &poolForConfiguration(Class componentClass, const CKComponentViewConfiguration &config);
+
       std::unordered_map<ViewKey, ViewReusePool> map;
       std::vector<UIView *> vendedViews;
 
@@ -165,7 +241,28 @@ namespace CK {
 
     class AttributeApplicator {
     public:
+      /**
+       Applies the configuration's attributes to the view. The attributes last applied to the view are persisted on it,
+       so when a view is recycled only attributes whose value differs are (un)applied.
+       */
       static void apply(UIView *view, const CKComponentViewConfiguration &config);
+
+      struct Statistics {
+        /** Attributes for which an applicator or updater was invoked. */
+        NSUInteger appliedCount;
+        /** Attributes skipped because the recycled view already carried an equal value. */
+        NSUInteger skippedCount;
+
+        /** The fraction of attributes that did not need to be applied, or 0 if none were seen. */
+        CGFloat skipRate() const {
+          const NSUInteger total = appliedCount + skippedCount;
+          return total ? (CGFloat)skippedCount / total : 0;
+        }
+      };
+
+      /** Cumulative counts since launch or the last call to resetStatistics(). Main thread only. */
+      static Statistics statistics();
+      static void resetStatistics();
     };
   }
 }
@@ -10,15 +10,16 @@
 
 #include "ComponentViewManager.h"
 
+#import <algorithm>
 #import <objc/runtime.h>
+#import <tuple>
+#import <utility>
 #import <unordered_map>
 
-#import "CKMutex.h"
-
 #import <ComponentKit/CKAssert.h>
 
 #import "CKInternalHelpers.h"
-#import "CKMutex.h"
+#import "CKInterner.h"
 #import "ComponentUtilities.h"
 #import "ComponentViewReuseUtilities.h"
 #import "CKComponentInternal.h"
@@ -30,62 +31,34 @@ using namespace CK::Component;
 
 namespace CK {
   namespace Component {
-    struct PersistentAttributeShapeKey {
-      /** Identifiers in sorted order. For the small sizes we use, this is faster than set or unordered_set. */
-      std::vector<std::string> identifiers;
-      /** Cumulative hash of all identifiers */
-      size_t hash;
-
-      /** Initialize the hash field to 0; remember that C++ doesn't initialize POD fields by default. */
-      PersistentAttributeShapeKey() : hash(0) {};
+    /** Interned identifiers of an attribute shape, in the sorted order of CKViewComponentAttributeValueMap. */
+    typedef std::vector<int32_t> PersistentAttributeShapeKey;
 
-      void addString(const std::string &s)
+    struct PersistentAttributeShapeKeyHash {
+      size_t operator()(const PersistentAttributeShapeKey &k) const
       {
-        identifiers.insert(std::lower_bound(identifiers.begin(), identifiers.end(), s), s);
-        // XOR'ing hashes is often a bad idea. Two of the reasons why are that two identical values will cancel each
-        // other out, and that ordering information is lost (a ^ b == b ^ a). Since we don't expect identical values and
-        // ordering doesn't matter (indeed *must not* matter), go ahead and use XOR here.
-        hash ^= std::hash<std::string>()(s);
-      }
-
-      bool operator==(const CK::Component::PersistentAttributeShapeKey &k) const
-      {
-        return identifiers == k.identifiers;
+        size_t hash = k.size();
+        for (const int32_t identifier : k) {
+          hash = hash * 31 + identifier;
+        }
+        return hash;
       }
     };
   }
 }
 
-namespace std {
-  template <> struct hash<const CK::Component::PersistentAttributeShapeKey>
-  {
-    size_t operator()(const CK::Component::PersistentAttributeShapeKey &k) const { return k.hash; }
-  };
-}
-
 int32_t PersistentAttributeShape::computeIdentifier(const CKViewComponentAttributeValueMap &attributes)
 {
   CK::Component::PersistentAttributeShapeKey key;
   for (const auto &it : attributes) {
     if (it.first.unapplicator == nil) {
-      key.addString(it.first.identifier);
+      key.push_back(it.first.internedIdentifier);
     }
   }
 
-  static CK::StaticMutex lock = CK_MUTEX_INITIALIZER; // protects identifierMap
-  CK::StaticMutexLocker l(lock);
-  static auto *identifierMap = new std::unordered_map<const CK::Component::PersistentAttributeShapeKey, const int32_t>();
-
-  static int32_t nextIdentifier = 0;
-  const auto it = identifierMap->find(key);
-  if (it == identifierMap->end()) {
-    // We don't need fancy OSAtomicIncrement64 here because we're already under the StaticMutex (for identifierMap).
-    int32_t identifier = nextIdentifier++;
-    identifierMap->emplace(std::move(key), identifier);
-    return identifier;
-  } else {
-    return it->second;
-  }
+  static auto *interner = new CK::Interner<CK::Component::PersistentAttributeShapeKey,
+                                           CK::Component::PersistentAttributeShapeKeyHash>();
+  return interner->intern(key);
 }
 
 @interface CKComponentAttributeSetWrapper : NSObject
@@ -101,23 +74,100 @@ int32_t PersistentAttributeShape::computeIdentifier(const CKViewComponentAttribu
 }
 @end
 
+/** Entries are never erased, so pointers to them stay valid; see ViewReusePool::statistics. */
+static std::unordered_map<ViewKey, ViewKeyStatistics> &viewKeyStatistics()
+{
+  static auto *statistics = new std::unordered_map<ViewKey, ViewKeyStatistics>();
+  return *statistics;
+}
+
+UIView *ViewReusePool::createView(const CKComponentViewClass &viewClass, UIView *container)
+{
+  UIView *v = viewClass.createView();
+  CKCAssertNotNil(v, @"Expected non-nil view to be created for view class %s", viewClass.getIdentifier().c_str());
+  [container addSubview:v];
+  ViewReuseUtilities::createdView(v, viewClass, container);
+  return v;
+}
+
+static NSUInteger sharedViewReusePoolMaximumViewsPerKey = 0;
+
+static std::unordered_map<ViewKey, std::vector<UIView *>> &sharedViewReusePoolViews()
+{
+  static auto *views = new std::unordered_map<ViewKey, std::vector<UIView *>>();
+  return *views;
+}
+
+void SharedViewReusePool::setMaximumViewsPerKey(NSUInteger maximumViewsPerKey)
+{
+  CKCAssertMainThread();
+  sharedViewReusePoolMaximumViewsPerKey = maximumViewsPerKey;
+  for (auto &it : sharedViewReusePoolViews()) {
+    if (it.second.size() > maximumViewsPerKey) {
+      it.second.resize(maximumViewsPerKey);
+    }
+  }
+}
+
+NSUInteger SharedViewReusePool::maximumViewsPerKey()
+{
+  CKCAssertMainThread();
+  return sharedViewReusePoolMaximumViewsPerKey;
+}
+
+NSUInteger SharedViewReusePool::viewCount()
+{
+  CKCAssertMainThread();
+  NSUInteger count = 0;
+  for (const auto &it : sharedViewReusePoolViews()) {
+    count += it.second.size();
+  }
+  return count;
+}
+
 UIView *ViewReusePool::viewForClass(const CKComponentViewClass &viewClass, UIView *container)
 {
   if (position == pool.end()) {
-    UIView *v = viewClass.createView();
-    CKCAssertNotNil(v, @"Expected non-nil view to be created for view class %s", viewClass.getIdentifier().c_str());
-    [container addSubview:v];
+    UIView *v = nil;
+    if (sharedViewReusePoolMaximumViewsPerKey > 0) {
+      auto &sharedViews = sharedViewReusePoolViews()[*key];
+      if (!sharedViews.empty()) {
+        v = sharedViews.back();
+        sharedViews.pop_back();
+        // The view stays hidden until reset(), like any other view vended during this pass.
+        [container addSubview:v];
+        ViewReuseUtilities::addedView(v, container);
+        statistics->sharedPoolHitCount++;
+      }
+    }
+    if (v == nil) {
+      statistics->missCount++;
+      v = createView(viewClass, container);
+    }
     pool.push_back(v);
     position = pool.end();
-    ViewReuseUtilities::createdView(v, viewClass, container);
     return v;
   } else {
     return *position++;
   }
 }
 
-void ViewReusePool::reset()
+void ViewReusePool::prewarm(const CKComponentViewClass &viewClass, UIView *container, NSUInteger count)
+{
+  // push_back invalidates position, so remember it as an offset.
+  const auto vendedCount = position - pool.begin();
+  while (pool.size() < count) {
+    UIView *v = createView(viewClass, container);
+    [v setHidden:YES];
+    ViewReuseUtilities::didHide(v);
+    pool.push_back(v);
+  }
+  position = pool.begin() + vendedCount;
+}
+
+void ViewReusePool::reset(UIView *container)
 {
+  statistics->peakVendedCount = std::max<NSUInteger>(statistics->peakVendedCount, position - pool.begin());
   for (auto it = pool.begin(); it != position; ++it) {
     ViewReuseUtilities::willUnhide(*it);
     [*it setHidden:NO];
@@ -126,6 +176,19 @@ void ViewReusePool::reset()
     [*it setHidden:YES];
     ViewReuseUtilities::didHide(*it);
   }
+
+  if (sharedViewReusePoolMaximumViewsPerKey > 0 && position != pool.end()) {
+    // Move as many of the views that were just hidden as fit into the shared pool, starting from the back.
+    auto &sharedViews = sharedViewReusePoolViews()[*key];
+    auto it = pool.end();
+    while (it != position && sharedViews.size() < sharedViewReusePoolMaximumViewsPerKey) {
+      --it;
+      [*it removeFromSuperview];
+      ViewReuseUtilities::removedView(*it, container);
+      sharedViews.push_back(*it);
+    }
+    pool.erase(it, pool.end());
+  }
   position = pool.begin();
 }
 
@@ -141,43 +204,101 @@ ViewReusePoolMap &ViewReusePoolMap::viewReusePoolMapForView(UIView *v)
   return wrapper->_viewReusePoolMap;
 }
 
-void ViewReusePoolMap::reset(UIView *container)
+/**
+ Returns the positions in sequence of a longest strictly increasing subsequence of it, in increasing order.
+ This is the standard O(n log n) algorithm: tails[k] is the position of the smallest value ending an increasing
+ subsequence of length k + 1 seen so far, and predecessors link each position to the previous one in its subsequence.
+ */
+static std::vector<size_t> longestIncreasingSubsequence(const std::vector<size_t> &sequence)
 {
-  for (auto &it : map) {
-    it.second.reset();
+  std::vector<size_t> tails;
+  std::vector<size_t> predecessors(sequence.size());
+  for (size_t i = 0; i < sequence.size(); i++) {
+    const auto tail = std::lower_bound(tails.begin(), tails.end(), sequence[i], [&](size_t position, size_t value) {
+      return sequence[position] < value;
+    });
+    predecessors[i] = (tail == tails.begin()) ? SIZE_MAX : *(tail - 1);
+    if (tail == tails.end()) {
+      tails.push_back(i);
+    } else {
+      *tail = i;
+    }
   }
 
-  // Now we need to ensure that the ordering of container.subviews matches vendedViews.
-  NSMutableArray *subviews = [[container subviews] mutableCopy];
-  std::vector<UIView *>::const_iterator nextVendedViewIt = vendedViews.cbegin();
+  std::vector<size_t> result(tails.size());
+  size_t position = tails.empty() ? SIZE_MAX : tails.back();
+  for (auto it = result.rbegin(); it != result.rend(); ++it) {
+    *it = position;
+    position = predecessors[position];
+  }
+  return result;
+}
 
-  // Can't use NSFastEnumeration since we mutate subviews during enumeration.
-  for (NSUInteger i = 0; i < [subviews count]; i++) {
-    UIView *subview = subviews[i];
+/**
+ Moves vended views among container's subviews so that they appear in the order they were vended, leaving subviews
+ that were not vended (hidden views, or views not created by the components infra) where they are.
 
-    // We use linear search here. We could create a std::unordered_set of vended views, but given the typical size of
-    // the list of vended views, I guessed a linear search would probably be faster considering constant factors.
-    const auto &vendedViewIt = std::find(nextVendedViewIt, vendedViews.cend(), subview);
+ Views that are part of a longest run of vended views already in the right relative order stay put; every other vended
+ view is moved exactly once, which is the minimal number of moves. When nothing changed, no view is moved.
+ */
+static void reorderSubviews(UIView *container, const std::vector<UIView *> &vendedViews)
+{
+  if (vendedViews.size() < 2) {
+    return;
+  }
 
-    if (vendedViewIt == vendedViews.cend()) {
-      // Ignore subviews not created by components infra, or that were not vended during this pass (they are hidden).
-      continue;
+  // A sorted index from view to its position in vendedViews; cheaper than a hash map at the sizes we see.
+  std::vector<std::pair<UIView *, size_t>> vendedIndex;
+  vendedIndex.reserve(vendedViews.size());
+  for (size_t i = 0; i < vendedViews.size(); i++) {
+    vendedIndex.push_back({vendedViews[i], i});
+  }
+  std::sort(vendedIndex.begin(), vendedIndex.end());
+
+  // The vended positions of vended views, in their current order among the subviews.
+  std::vector<size_t> currentOrder;
+  currentOrder.reserve(vendedViews.size());
+  for (UIView *subview in [container subviews]) {
+    const auto it = std::lower_bound(vendedIndex.begin(), vendedIndex.end(), std::make_pair(subview, (size_t)0));
+    if (it != vendedIndex.end() && it->first == subview) {
+      currentOrder.push_back(it->second);
     }
+  }
+  CKCAssert(currentOrder.size() == vendedViews.size(), @"Expected all vended views to be subviews of %@", [container class]);
 
-    if (vendedViewIt != nextVendedViewIt) {
-      NSUInteger swapIndex = [subviews indexOfObjectIdenticalTo:*nextVendedViewIt];
-      CKCAssert(swapIndex != NSNotFound, @"Expected to find subview %@ in %@",
-                [*nextVendedViewIt class], [container class]);
+  const std::vector<size_t> stayingPositions = longestIncreasingSubsequence(currentOrder);
+  if (stayingPositions.size() == currentOrder.size()) {
+    return;
+  }
+  std::vector<bool> staying(vendedViews.size(), false);
+  for (const size_t position : stayingPositions) {
+    staying[currentOrder[position]] = true;
+  }
 
-      // This naive algorithm does not do the minimal number of swaps. But it's simple, and swaps should be relatively
-      // rare in any case, so let's go with it.
-      [subviews exchangeObjectAtIndex:i withObjectAtIndex:swapIndex];
-      [container exchangeSubviewAtIndex:i withSubviewAtIndex:swapIndex];
+  // Walking in vended order, place each moving view directly above its predecessor, which is by then correctly placed.
+  // A moving view with no predecessor goes directly below the first view that stays.
+  UIView *firstStayingView = vendedViews[currentOrder[stayingPositions.front()]];
+  for (size_t i = 0; i < vendedViews.size(); i++) {
+    if (staying[i]) {
+      continue;
+    }
+    if (i == 0) {
+      [container insertSubview:vendedViews[i] belowSubview:firstStayingView];
+    } else {
+      [container insertSubview:vendedViews[i] aboveSubview:vendedViews[i - 1]];
     }
+  }
+}
 
-    ++nextVendedViewIt;
+void ViewReusePoolMap::reset(UIView *container)
+{
+  for (auto &it : map) {
+    it.second.reset(container);
   }
 
+  // Now we need to ensure that the ordering of container.subviews matches vendedViews.
+  reorderSubviews(container, vendedViews);
+
   vendedViews.clear();
 }
 
@@ -189,15 +310,64 @@ UIView *ViewReusePoolMap::viewForConfiguration(Class componentClass,
     return nil;
   }
 
+  UIView *v = poolForConfiguration(componentClass, config).viewForClass(config.viewClass(), container);
+  vendedViews.push_back(v);
+  return v;
+}
+
+ViewReusePool &ViewReusePoolMap::poolForConfiguration(Class componentClass, const CKComponentViewConfiguration &config)
+{
   const Component::ViewKey key = {
     componentClass,
-    config.viewClass().getIdentifier(),
+    config.viewClass().getInternedIdentifier(),
     config.rep->attributeShape
   };
-  // Note that operator[] creates a new ViewReusePool if one doesn't exist yet. This is what we want.
-  UIView *v = map[key].viewForClass(config.viewClass(), container);
-  vendedViews.push_back(v);
-  return v;
+  auto it = map.find(key);
+  if (it == map.end()) {
+    it = map.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+    // Nodes of an unordered_map never move, so the pool can keep pointers to its key.
+    it->second.key = &it->first;
+    it->second.statistics = &viewKeyStatistics()[key];
+  }
+  return it->second;
+}
+
+void ViewReusePoolMap::prewarm(Class componentClass,
+                               const CKComponentViewConfiguration &config,
+                               UIView *container,
+                               NSUInteger count)
+{
+  CKCAssertMainThread();
+  CKCAssert(vendedViews.empty(), @"Prewarming %@ while views are being vended into it", container);
+  if (!config.viewClass().hasView()) {
+    return;
+  }
+  poolForConfiguration(componentClass, config).prewarm(config.viewClass(), container, count);
+}
+
+void ViewReusePoolMap::prewarm(Class componentClass, const CKComponentViewConfiguration &config, UIView *container)
+{
+  CKCAssertMainThread();
+  if (!config.viewClass().hasView()) {
+    return;
+  }
+  const NSUInteger peakVendedCount = poolForConfiguration(componentClass, config).statistics->peakVendedCount;
+  prewarm(componentClass, config, container, std::max<NSUInteger>(1, peakVendedCount));
+}
+
+std::unordered_map<ViewKey, ViewKeyStatistics> ViewReusePoolMap::statistics()
+{
+  CKCAssertMainThread();
+  return viewKeyStatistics();
+}
+
+void ViewReusePoolMap::resetStatistics()
+{
+  CKCAssertMainThread();
+  // Zero rather than clear, since pools hold pointers to the entries.
+  for (auto &it : viewKeyStatistics()) {
+    it.second = {};
+  }
 }
 
 UIView *ViewManager::viewForConfiguration(Class componentClass, const CKComponentViewConfiguration &config)
@@ -207,6 +377,8 @@ UIView *ViewManager::viewForConfiguration(Class componentClass, const CKComponen
 
 static char kPersistentAttributesViewKey = ' ';
 
+static AttributeApplicator::Statistics attributeApplicatorStatistics;
+
 void AttributeApplicator::apply(UIView *view, const CKComponentViewConfiguration &config)
 {
   // Reset optimistic mutations so that applicators see they see the state they expect.
@@ -222,13 +394,32 @@ void AttributeApplicator::apply(UIView *view, const CKComponentViewConfiguration
                              wrapper,
                              OBJC_ASSOCIATION_RETAIN_NONATOMIC);
   }
+  if (wrapper->_attributes == config.attributes()) {
+    // The view already carries exactly these attributes.
+    attributeApplicatorStatistics.skippedCount += wrapper->_attributes->size();
+    return;
+  }
+
   const CKViewComponentAttributeValueMap &oldAttributes = wrapper->_attributes ? *wrapper->_attributes : *empty;
   const CKViewComponentAttributeValueMap &newAttributes = *config.attributes();
 
+  // Both maps are sorted by interned identifier, so rather than looking up each attribute in the other map, each loop
+  // below advances a cursor through the other map in step.
+  const auto advance = [](CKViewComponentAttributeValueMap::const_iterator it,
+                          CKViewComponentAttributeValueMap::const_iterator end,
+                          const CKComponentViewAttribute &attr) {
+    while (it != end && it->first.internedIdentifier < attr.internedIdentifier) {
+      ++it;
+    }
+    return it;
+  };
+
   // First, tear down any attributes that appear in the *old* set but not the new set, and *do* have an unapplicator.
+  auto newCursor = newAttributes.begin();
   for (const auto &oldAttr : oldAttributes) {
+    newCursor = advance(newCursor, newAttributes.end(), oldAttr.first);
     if (oldAttr.first.unapplicator) {
-      const auto &newAttr = newAttributes.find(oldAttr.first);
+      const auto newAttr = (newCursor != newAttributes.end() && newCursor->first == oldAttr.first) ? newCursor : newAttributes.end();
       if (newAttr == newAttributes.end()) {
         // There is no new attribute, so we always must call "unapplicator".
         oldAttr.first.unapplicator(view, oldAttr.second);
@@ -242,11 +433,14 @@ void AttributeApplicator::apply(UIView *view, const CKComponentViewConfiguration
   }
 
   // Now apply the applicators for all attributes in the *new* set, except those that haven't changed in value.
+  auto oldCursor = oldAttributes.begin();
   for (const auto &newAttr : newAttributes) {
-    const auto &oldAttr = oldAttributes.find(newAttr.first);
+    oldCursor = advance(oldCursor, oldAttributes.end(), newAttr.first);
+    const auto oldAttr = (oldCursor != oldAttributes.end() && oldCursor->first == newAttr.first) ? oldCursor : oldAttributes.end();
     if (oldAttr == oldAttributes.end()) {
       // There is no old attribute, so we always must call "applicator".
       newAttr.first.applicator(view, newAttr.second);
+      attributeApplicatorStatistics.appliedCount++;
     } else if (!CKObjectIsEqual(oldAttr->second, newAttr.second)) {
       // If the attribute has an "updater", call that. Otherwise, call the applicator.
       if (newAttr.first.updater) {
@@ -254,6 +448,9 @@ void AttributeApplicator::apply(UIView *view, const CKComponentViewConfiguration
       } else {
         newAttr.first.applicator(view, newAttr.second);
       }
+      attributeApplicatorStatistics.appliedCount++;
+    } else {
+      attributeApplicatorStatistics.skippedCount++;
     }
   }
 
@@ -261,6 +458,18 @@ void AttributeApplicator::apply(UIView *view, const CKComponentViewConfiguration
   wrapper->_attributes = config.attributes();
 }
 
+AttributeApplicator::Statistics AttributeApplicator::statistics()
+{
+  CKCAssertMainThread();
+  return attributeApplicatorStatistics;
+}
+
+void AttributeApplicator::resetStatistics()
+{
+  CKCAssertMainThread();
+  attributeApplicatorStatistics = {};
+}
+
 @implementation CKComponentAttributeSetWrapper
 @end
 
@@ -29,6 +29,11 @@ namespace CK {
       static void didHide(UIView *view);
       /** Called when Components is about to unhide a Components-managed view */
       static void willUnhide(UIView *view);
+
+      /** Called when Components has removed a hidden Components-managed view from its parent to reuse it elsewhere */
+      static void removedView(UIView *view, UIView *parent);
+      /** Called when Components has added a hidden Components-managed view removed from another parent to a new one */
+      static void addedView(UIView *view, UIView *parent);
     };
   }
 }
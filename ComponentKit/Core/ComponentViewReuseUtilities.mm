@@ -25,6 +25,8 @@ static char const kViewReuseInfoKey = ' ';
       didEnterReusePoolBlock:(void (^)(UIView *))didEnterReusePoolBlock
      willLeaveReusePoolBlock:(void (^)(UIView *))willLeaveReusePoolBlock;
 - (void)registerChildViewInfo:(CKComponentViewReuseInfo *)info;
+- (void)unregisterChildViewInfo:(CKComponentViewReuseInfo *)info;
+- (BOOL)isEffectivelyHidden;
 - (void)didHide;
 - (void)willUnhide;
 - (void)ancestorDidHide;
@@ -91,6 +93,29 @@ void ViewReuseUtilities::willUnhide(UIView *view)
   [info willUnhide];
 }
 
+void ViewReuseUtilities::removedView(UIView *view, UIView *parent)
+{
+  CKComponentViewReuseInfo *info = objc_getAssociatedObject(view, &kViewReuseInfoKey);
+  CKCAssertNotNil(info, @"Expect to find reuse info on all components-managed views but found none on %@", view);
+  CKComponentViewReuseInfo *parentInfo = objc_getAssociatedObject(parent, &kViewReuseInfoKey);
+  [parentInfo unregisterChildViewInfo:info];
+}
+
+void ViewReuseUtilities::addedView(UIView *view, UIView *parent)
+{
+  CKComponentViewReuseInfo *info = objc_getAssociatedObject(view, &kViewReuseInfoKey);
+  CKCAssertNotNil(info, @"Expect to find reuse info on all components-managed views but found none on %@", view);
+  CKComponentViewReuseInfo *parentInfo = objc_getAssociatedObject(parent, &kViewReuseInfoKey);
+  CKCAssertNotNil(parentInfo, @"Expected parentInfo but found none on %@", parent);
+  [parentInfo registerChildViewInfo:info];
+  // The view may have been hidden under an ancestor that is not hidden here, or vice versa.
+  if ([parentInfo isEffectivelyHidden]) {
+    [info ancestorDidHide];
+  } else {
+    [info ancestorWillUnhide];
+  }
+}
+
 @implementation CKComponentViewReuseInfo
 {
   // Weak to prevent a retain cycle since the view holds the info strongly via associated objects
@@ -122,6 +147,16 @@ void ViewReuseUtilities::willUnhide(UIView *view)
   [_childViewInfos addObject:info];
 }
 
+- (void)unregisterChildViewInfo:(CKComponentViewReuseInfo *)info
+{
+  [_childViewInfos removeObjectIdenticalTo:info];
+}
+
+- (BOOL)isEffectivelyHidden
+{
+  return _hidden || _ancestorHidden;
+}
+
 - (void)didHide
 {
   if (_hidden) {
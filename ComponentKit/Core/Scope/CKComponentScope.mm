@@ -104,7 +104,7 @@ CKComponentScope::CKComponentScope(Class __unsafe_unretained componentClass, id
                                                                       controller:controller];
 
   // Set the new scope to be the "current", top-level scope.
-  CKThreadLocalComponentScope::cursor()->pushFrameAndEquivalentPreviousFrame(scopeFrame, equivalentPreviousFrame);
+  cursor->pushFrameAndEquivalentPreviousFrame(scopeFrame, equivalentPreviousFrame);
 
   _scopeFrame = scopeFrame;
 }
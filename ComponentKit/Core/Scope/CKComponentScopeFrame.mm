@@ -10,6 +10,7 @@
 
 #import "CKComponentScopeFrame.h"
 
+#import <atomic>
 #import <unordered_map>
 #import <vector>
 
@@ -49,6 +50,54 @@ static const std::vector<SEL> announceableEvents = {
   @selector(componentTreeDidDisappear),
 };
 
+/** Bit i is set if the controller class overrides announceableEvents[i]. */
+typedef uint32_t CKAnnounceableEventMask;
+
+/** Class pointers are at least 8-byte aligned, which leaves room for a mask of up to three events in the low bits. */
+static const uintptr_t kAnnounceableEventMaskBits = 0x7;
+
+static CKAnnounceableEventMask CKComputeAnnounceableEventMask(Class controllerClass)
+{
+  CKAnnounceableEventMask mask = 0;
+  for (size_t i = 0; i < announceableEvents.size(); i++) {
+    if (CKSubclassOverridesSelector([CKComponentController class], controllerClass, announceableEvents[i])) {
+      mask |= (1 << i);
+    }
+  }
+  CKCAssert(mask <= kAnnounceableEventMaskBits, @"Too many announceable events to pack a mask next to a class pointer");
+  return mask;
+}
+
+/**
+ Open-addressed and insert-only, so looking up a class never takes a lock: each slot is published once with a single
+ compare-and-swap of the class pointer and its mask packed together. There are far fewer controller classes than slots;
+ if the table ever fills up, masks are computed without being cached.
+ */
+static const size_t kAnnounceableEventMaskCacheSize = 1024;
+static std::atomic<uintptr_t> announceableEventMaskCache[kAnnounceableEventMaskCacheSize];
+
+static CKAnnounceableEventMask CKAnnounceableEventMaskForControllerClass(Class controllerClass)
+{
+  const uintptr_t classBits = (uintptr_t)controllerClass;
+  CKCAssert((classBits & kAnnounceableEventMaskBits) == 0, @"Unexpectedly unaligned class pointer %p", controllerClass);
+  size_t index = (classBits >> 4) % kAnnounceableEventMaskCacheSize;
+  for (size_t probe = 0; probe < kAnnounceableEventMaskCacheSize; probe++) {
+    uintptr_t slot = announceableEventMaskCache[index].load(std::memory_order_acquire);
+    if (slot == 0) {
+      const uintptr_t entry = classBits | CKComputeAnnounceableEventMask(controllerClass);
+      if (announceableEventMaskCache[index].compare_exchange_strong(slot, entry, std::memory_order_acq_rel)) {
+        return entry & kAnnounceableEventMaskBits;
+      }
+      // Another thread published this slot first; slot now holds its entry, which may be for this very class.
+    }
+    if ((slot & ~kAnnounceableEventMaskBits) == classBits) {
+      return slot & kAnnounceableEventMaskBits;
+    }
+    index = (index + 1) % kAnnounceableEventMaskCacheSize;
+  }
+  return CKComputeAnnounceableEventMask(controllerClass);
+}
+
 @interface CKComponentScopeFrame ()
 @property (nonatomic, weak, readwrite) CKComponentScopeFrame *root;
 @end
@@ -56,7 +105,8 @@ static const std::vector<SEL> announceableEvents = {
 @implementation CKComponentScopeFrame {
   id _modifiedState;
   std::unordered_map<_CKStateScopeKey, CKComponentScopeFrame *> _children;
-  std::unordered_multimap<SEL, CKComponentController *> _eventRegistration;
+  /** Only populated on the root frame; indexed in parallel with announceableEvents. */
+  std::vector<std::vector<CKComponentController *>> _eventRegistration;
 }
 
 - (instancetype)initWithListener:(id<CKComponentStateListener>)listener
@@ -74,9 +124,10 @@ static const std::vector<SEL> announceableEvents = {
     _controller = controller;
     _root = rootFrame ? rootFrame : self;
 
-    for (const auto announceableEvent : announceableEvents) {
-      if (CKSubclassOverridesSelector([CKComponentController class], [controller class], announceableEvent)) {
-        [_root registerController:controller forSelector:announceableEvent];
+    if (controller) {
+      const CKAnnounceableEventMask mask = CKAnnounceableEventMaskForControllerClass([controller class]);
+      if (mask) {
+        [_root registerController:controller forEventMask:mask];
       }
     }
   }
@@ -173,20 +224,31 @@ static const std::vector<SEL> announceableEvents = {
   _owningComponent = component;
 }
 
-- (void)registerController:(CKComponentController *)controller forSelector:(SEL)selector
+- (void)registerController:(CKComponentController *)controller forEventMask:(CKAnnounceableEventMask)mask
 {
-  _eventRegistration.insert({{selector, controller}});
+  if (_eventRegistration.empty()) {
+    _eventRegistration.resize(announceableEvents.size());
+  }
+  for (size_t i = 0; i < announceableEvents.size(); i++) {
+    if (mask & (1 << i)) {
+      _eventRegistration[i].push_back(controller);
+    }
+  }
 }
 
 - (void)announceEventToControllers:(SEL)selector
 {
-  CKAssert(std::find(announceableEvents.begin(), announceableEvents.end(), selector) != announceableEvents.end(),
+  const auto it = std::find(announceableEvents.begin(), announceableEvents.end(), selector);
+  CKAssert(it != announceableEvents.end(),
            @"Can only announce a whitelisted events, and %@ is not on the list.", NSStringFromSelector(selector));
-  auto range = _eventRegistration.equal_range(selector);
-  for (auto it = range.first; it != range.second; ++it) {
+  const size_t eventIndex = it - announceableEvents.begin();
+  if (eventIndex >= _eventRegistration.size()) {
+    return;
+  }
+  for (CKComponentController *controller : _eventRegistration[eventIndex]) {
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Warc-performSelector-leaks"
-    [it->second performSelector:selector];
+    [controller performSelector:selector];
 #pragma clang diagnostic pop
   }
 }
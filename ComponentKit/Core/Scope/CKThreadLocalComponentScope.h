@@ -8,7 +8,7 @@
  *
  */
 
-#import <stack>
+#import <vector>
 
 #import <Foundation/Foundation.h>
 
@@ -23,16 +23,21 @@ class CKComponentScopeCursor {
     CKComponentScopeFrame *equivalentPreviousFrame;
   };
 
-  std::stack<CKComponentScopeCursorFrame> _frames;
+  std::vector<CKComponentScopeCursorFrame> _frames;
  public:
+  CKComponentScopeCursor();
+
   /** Push a new frame onto both state-trees. */
   void pushFrameAndEquivalentPreviousFrame(CKComponentScopeFrame *frame, CKComponentScopeFrame *equivalentPreviousFrame);
 
   /** Pop off one frame on both state trees.  */
-  void popFrame();
+  void popFrame() { _frames.pop_back(); }
 
-  CKComponentScopeFrame *currentFrame() const;
-  CKComponentScopeFrame *equivalentPreviousFrame() const;
+  CKComponentScopeFrame *currentFrame() const { return _frames.empty() ? nullptr : _frames.back().frame; }
+  CKComponentScopeFrame *equivalentPreviousFrame() const
+  {
+    return _frames.empty() ? nullptr : _frames.back().equivalentPreviousFrame;
+  }
 
   bool empty() const { return _frames.empty(); }
 };
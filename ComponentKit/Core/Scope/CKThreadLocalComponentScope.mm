@@ -11,33 +11,31 @@
 #import "CKThreadLocalComponentScope.h"
 
 #import <pthread.h>
-#import <stack>
 
 #import <ComponentKit/CKAssert.h>
 
 #import "CKComponentScopeFrame.h"
 #import "CKComponentScopeInternal.h"
 
-void CKComponentScopeCursor::pushFrameAndEquivalentPreviousFrame(CKComponentScopeFrame *frame, CKComponentScopeFrame *equivalentFrame)
-{
-  _frames.push({frame, equivalentFrame});
-}
-
-void CKComponentScopeCursor::popFrame()
-{
-  _frames.pop();
-}
+/**
+ Component trees are rarely more than a few dozen scopes deep; reserving up front means pushing a scope never has to
+ allocate once a thread has built its first tree.
+ */
+static const size_t kInitialCursorCapacity = 64;
 
-CKComponentScopeFrame *CKComponentScopeCursor::currentFrame() const
+CKComponentScopeCursor::CKComponentScopeCursor()
 {
-  return _frames.empty() ? nullptr :  _frames.top().frame;
+  _frames.reserve(kInitialCursorCapacity);
 }
 
-CKComponentScopeFrame *CKComponentScopeCursor::equivalentPreviousFrame() const
+void CKComponentScopeCursor::pushFrameAndEquivalentPreviousFrame(CKComponentScopeFrame *frame, CKComponentScopeFrame *equivalentFrame)
 {
-  return _frames.empty() ? nullptr : _frames.top().equivalentPreviousFrame;
+  _frames.push_back({frame, equivalentFrame});
 }
 
+// The __thread pointer is the fast path (a single TLS load); the pthread key only exists to delete the cursor when the
+// thread exits, since the C++11 toolchain we target does not support thread_local for non-trivial types.
+static __thread CKComponentScopeCursor *thread_cursor;
 static pthread_key_t thread_key;
 static pthread_once_t key_once = PTHREAD_ONCE_INIT;
 
@@ -52,27 +50,33 @@ static void _makeThreadKey()
   (void)pthread_key_create(&thread_key, _valueDestructor);
 }
 
-CKComponentScopeCursor *CKThreadLocalComponentScope::cursor()
+static CKComponentScopeCursor *_newCursorForCurrentThread()
 {
-  // Return the TLS, allocating if this is the first time through.
   (void)pthread_once(&key_once, _makeThreadKey);
-  CKComponentScopeCursor *cursor = (CKComponentScopeCursor *)pthread_getspecific(thread_key);
-  if (!cursor) {
-    cursor = new CKComponentScopeCursor;
-    pthread_setspecific(thread_key, cursor);
-  }
+  CKComponentScopeCursor *cursor = new CKComponentScopeCursor;
+  pthread_setspecific(thread_key, cursor);
+  thread_cursor = cursor;
   return cursor;
 }
 
+CKComponentScopeCursor *CKThreadLocalComponentScope::cursor()
+{
+  // Return the TLS, allocating if this is the first time through.
+  CKComponentScopeCursor *cursor = thread_cursor;
+  return __builtin_expect(cursor != nullptr, 1) ? cursor : _newCursorForCurrentThread();
+}
+
 CKThreadLocalComponentScope::CKThreadLocalComponentScope(id<CKComponentStateListener> listener,
                                                          CKComponentScopeFrame *previousRootFrame)
 {
-  CKCAssert(cursor()->empty(), @"CKThreadLocalStateScope already exists. You cannot create two at the same time.");
-  cursor()->pushFrameAndEquivalentPreviousFrame([CKComponentScopeFrame rootFrameWithListener:listener], previousRootFrame);
+  CKComponentScopeCursor *c = cursor();
+  CKCAssert(c->empty(), @"CKThreadLocalStateScope already exists. You cannot create two at the same time.");
+  c->pushFrameAndEquivalentPreviousFrame([CKComponentScopeFrame rootFrameWithListener:listener], previousRootFrame);
 }
 
 CKThreadLocalComponentScope::~CKThreadLocalComponentScope() throw(...)
 {
-  cursor()->popFrame();
-  CKCAssert(cursor()->empty(), @"");
+  CKComponentScopeCursor *c = cursor();
+  c->popFrame();
+  CKCAssert(c->empty(), @"");
 }
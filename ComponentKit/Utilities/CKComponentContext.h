@@ -26,7 +26,7 @@ public:
 
    @example CKComponentContext<CKFoo> fooContext(foo);
    */
-  CKComponentContext(T *object) : _key([T class])
+  CKComponentContext(T *object) : _key(CK::Component::Context::typeIndex<T>())
   {
     CK::Component::Context::store(_key, object);
   }
@@ -40,7 +40,7 @@ public:
    */
   static T *get()
   {
-    return CK::Component::Context::fetch([T class]);
+    return CK::Component::Context::fetch(CK::Component::Context::typeIndex<T>());
   }
 
   CKComponentContext(const CKComponentContext&) = delete;
@@ -51,5 +51,5 @@ public:
   }
 
 private:
-  const Class _key;
+  const NSUInteger _key;
 };
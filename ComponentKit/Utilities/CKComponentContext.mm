@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant 
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import "CKComponentContext.h"
+
+#import <libkern/OSAtomic.h>
+#import <pthread.h>
+#import <vector>
+
+#import "CKAssert.h"
+
+namespace CK {
+  namespace Component {
+    namespace Context {
+
+      /** The objects currently in context on one thread, indexed by typeIndex(). Never shrinks. */
+      struct Storage {
+        std::vector<id> objects;
+      };
+
+      // __thread gives us a direct TLS load on the fast path; the pthread key only exists so that storage is freed
+      // when the owning thread exits.
+      static __thread Storage *_threadStorage;
+      static pthread_key_t _threadStorageKey;
+      static pthread_once_t _threadStorageKeyOnce = PTHREAD_ONCE_INIT;
+
+      static void _destroyStorage(void *storage)
+      {
+        delete (Storage *)storage;
+      }
+
+      static void _makeThreadStorageKey()
+      {
+        (void)pthread_key_create(&_threadStorageKey, _destroyStorage);
+      }
+
+      static Storage &storage()
+      {
+        if (__builtin_expect(_threadStorage == nullptr, 0)) {
+          (void)pthread_once(&_threadStorageKeyOnce, _makeThreadStorageKey);
+          _threadStorage = new Storage;
+          pthread_setspecific(_threadStorageKey, _threadStorage);
+        }
+        return *_threadStorage;
+      }
+
+      NSUInteger nextTypeIndex()
+      {
+        static volatile int32_t lastIndex = -1;
+        return (NSUInteger)OSAtomicIncrement32(&lastIndex);
+      }
+
+      void store(NSUInteger index, id object)
+      {
+        CKCAssertNotNil(object, @"Cannot store nil objects");
+        std::vector<id> &objects = storage().objects;
+        if (index >= objects.size()) {
+          objects.resize(index + 1);
+        }
+        CKCAssertNil(objects[index], @"Cannot store %@ as %@ already exists", object, objects[index]);
+        objects[index] = object;
+      }
+
+      void clear(NSUInteger index)
+      {
+        std::vector<id> &objects = storage().objects;
+        CKCAssert(index < objects.size() && objects[index] != nil, @"Who removed %@ behind our back?", @(index));
+        if (index < objects.size()) {
+          objects[index] = nil;
+        }
+      }
+
+      id fetch(NSUInteger index)
+      {
+        const Storage *s = _threadStorage;
+        return (s && index < s->objects.size()) ? s->objects[index] : nil;
+      }
+    }
+  }
+}
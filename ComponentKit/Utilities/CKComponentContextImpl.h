@@ -15,44 +15,23 @@
 namespace CK {
   namespace Component {
     namespace Context {
-      inline NSString *threadDictionaryKey()
-      {
-        return @"CKComponentContext";
-      }
-
-      inline NSMutableDictionary *contextDictionary(BOOL create)
-      {
-        NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
-        NSMutableDictionary *contextDictionary = [threadDictionary objectForKey:threadDictionaryKey()];
-        if (contextDictionary == nil && create) {
-          contextDictionary = [NSMutableDictionary dictionary];
-          [threadDictionary setObject:contextDictionary forKey:threadDictionaryKey()];
-        }
-        return contextDictionary;
-      }
+      /** Vends a new, process-wide unique index; see typeIndex(). */
+      NSUInteger nextTypeIndex();
 
-      inline void store(id key, id object)
+      /**
+       Returns a small integer uniquely identifying T. Contexts are stored in a per-thread array indexed by this value,
+       so storing, fetching and clearing an object never hashes or sends a message.
+       */
+      template<typename T>
+      NSUInteger typeIndex()
       {
-        CKCAssertNotNil(object, @"Cannot store nil objects");
-        NSMutableDictionary *c = contextDictionary(YES);
-        CKCAssertNil(c[key], @"Cannot store %@ = %@ as %@ already exists", key, object, c[key]);
-        c[key] = object;
+        static const NSUInteger index = nextTypeIndex();
+        return index;
       }
 
-      inline void clear(id key)
-      {
-        NSMutableDictionary *c = contextDictionary(NO);
-        CKCAssertNotNil(c[key], @"Who removed %@ behind our back?", key);
-        [c removeObjectForKey:key];
-        if ([c count] == 0) {
-          [[[NSThread currentThread] threadDictionary] removeObjectForKey:threadDictionaryKey()];
-        }
-      }
-
-      inline id fetch(id key)
-      {
-        return contextDictionary(NO)[key];
-      }
+      void store(NSUInteger index, id object);
+      void clear(NSUInteger index);
+      id fetch(NSUInteger index);
     };
   }
 }
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant 
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <atomic>
+#import <functional>
+
+#import <ComponentKit/CKMutex.h>
+
+namespace CK {
+  /**
+   Maps values to small, dense int32_t identifiers, starting at 0. Identifiers are never reclaimed.
+
+   Looking up a value that has already been interned is lock-free, so this is safe to use on hot paths from any thread:
+   the table is open-addressed and a slot only ever goes from empty to pointing at an immutable entry. Interning a new
+   value takes a lock. When the table grows, the new table is published atomically and the old slot array is leaked,
+   since a reader may still be probing it; the total leaked is bounded by the size of the final table.
+
+   Intended to be allocated once and never destroyed, e.g. `static auto *interner = new CK::Interner<std::string>();`.
+   */
+  template <typename Key, typename Hash = std::hash<Key>>
+  class Interner {
+  public:
+    Interner() : _table(newTable(kInitialCapacity)), _count(0) {}
+
+    int32_t intern(const Key &key)
+    {
+      const size_t hash = Hash()(key);
+      if (const Entry *entry = find(_table.load(std::memory_order_acquire), key, hash)) {
+        return entry->identifier;
+      }
+
+      CK::MutexLocker l(_lock);
+      Table *table = _table.load(std::memory_order_relaxed);
+      if (const Entry *entry = find(table, key, hash)) {
+        return entry->identifier; // Interned by another thread while we were waiting for the lock.
+      }
+      if ((_count + 1) * 2 > table->capacity) {
+        table = grow(table);
+      }
+      const Entry *entry = new Entry({key, hash, _count++});
+      insert(table, entry);
+      return entry->identifier;
+    }
+
+  private:
+    static const size_t kInitialCapacity = 32;
+
+    struct Entry {
+      const Key key;
+      const size_t hash;
+      const int32_t identifier;
+    };
+
+    struct Table {
+      size_t capacity; // Always a power of two.
+      std::atomic<const Entry *> *slots;
+    };
+
+    static Table *newTable(size_t capacity)
+    {
+      Table *table = new Table({capacity, new std::atomic<const Entry *>[capacity]});
+      for (size_t i = 0; i < capacity; i++) {
+        table->slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+      return table;
+    }
+
+    static const Entry *find(const Table *table, const Key &key, size_t hash)
+    {
+      const size_t mask = table->capacity - 1;
+      for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Entry *entry = table->slots[i].load(std::memory_order_acquire);
+        if (entry == nullptr) {
+          return nullptr;
+        }
+        if (entry->hash == hash && entry->key == key) {
+          return entry;
+        }
+      }
+    }
+
+    static void insert(Table *table, const Entry *entry)
+    {
+      const size_t mask = table->capacity - 1;
+      size_t i = entry->hash & mask;
+      while (table->slots[i].load(std::memory_order_relaxed) != nullptr) {
+        i = (i + 1) & mask;
+      }
+      table->slots[i].store(entry, std::memory_order_release);
+    }
+
+    Table *grow(const Table *table)
+    {
+      Table *grown = newTable(table->capacity * 2);
+      for (size_t i = 0; i < table->capacity; i++) {
+        if (const Entry *entry = table->slots[i].load(std::memory_order_relaxed)) {
+          insert(grown, entry);
+        }
+      }
+      _table.store(grown, std::memory_order_release);
+      return grown;
+    }
+
+    std::atomic<Table *> _table;
+    int32_t _count; // Guarded by _lock.
+    CK::Mutex _lock;
+
+    Interner(const Interner&) = delete;
+    Interner &operator=(const Interner&) = delete;
+  };
+}
@@ -54,4 +54,33 @@ static void openContextWithNSObject()
   XCTAssertNil(CKComponentContext<NSObject>::get(), @"Expected getting NSObject to return nil as its scope is closed");
 }
 
+- (void)testComponentContextsOfDifferentClassesCanBeNested
+{
+  NSObject *o = [[NSObject alloc] init];
+  CKComponentContext<NSObject> objectContext(o);
+  {
+    NSString *s = @"hello";
+    CKComponentContext<NSString> stringContext(s);
+    XCTAssertTrue(CKComponentContext<NSObject>::get() == o);
+    XCTAssertTrue(CKComponentContext<NSString>::get() == s);
+  }
+  XCTAssertTrue(CKComponentContext<NSObject>::get() == o);
+  XCTAssertNil(CKComponentContext<NSString>::get());
+}
+
+- (void)testComponentContextIsNotVisibleFromOtherThreads
+{
+  NSObject *o = [[NSObject alloc] init];
+  CKComponentContext<NSObject> context(o);
+
+  __block NSObject *fetchedOnOtherThread = o;
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    fetchedOnOtherThread = CKComponentContext<NSObject>::get();
+    dispatch_semaphore_signal(semaphore);
+  });
+  dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+  XCTAssertNil(fetchedOnOtherThread, @"Expected context to be thread-local");
+}
+
 @end
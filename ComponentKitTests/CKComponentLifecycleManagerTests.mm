@@ -14,6 +14,7 @@
 #import "CKComponentAnimation.h"
 #import "CKComponentController.h"
 #import "CKComponentLifecycleManager.h"
+#import "CKComponentLifecycleManagerInternal.h"
 #import "CKComponentProvider.h"
 #import "CKComponentScope.h"
 #import "CKComponentViewInterface.h"
@@ -189,6 +190,59 @@ static const CKSizeRange size = {{40, 40}, {40, 40}};
                         @"Expect the manager to leave view untouched after detach");
 }
 
+- (void)testMountStatisticsCountMountedAndUnmountedComponents
+{
+  CKComponentLifecycleManager *lifeManager = [[CKComponentLifecycleManager alloc] initWithComponentProvider:[self class]];
+  [lifeManager updateWithState:[lifeManager prepareForUpdateWithModel:[UIColor redColor] constrainedSize:size context:nil]];
+
+  UIView *view = [[UIView alloc] initWithFrame:CGRectMake(0.0, 0.0, 40.0, 40.0)];
+  [lifeManager attachToView:view];
+  XCTAssertEqual([lifeManager lastMountStatistics].mountedCount, 2u);
+  XCTAssertEqual([lifeManager lastMountStatistics].unmountedCount, 0u);
+
+  // Every update builds new components, so all components from the previous pass should be unmounted.
+  [lifeManager updateWithState:[lifeManager prepareForUpdateWithModel:[UIColor greenColor] constrainedSize:size context:nil]];
+  XCTAssertEqual([lifeManager lastMountStatistics].mountedCount, 2u);
+  XCTAssertEqual([lifeManager lastMountStatistics].unmountedCount, 2u);
+
+  [lifeManager detachFromView];
+  XCTAssertEqual([lifeManager lastMountStatistics].mountedCount, 0u);
+  XCTAssertEqual([lifeManager lastMountStatistics].unmountedCount, 2u);
+}
+
+/** Mounting small layouts incrementally usually finishes in the first slice, but spin the run loop in case it does not. */
+static BOOL waitForMountStatistics(CKComponentLifecycleManager *lifeManager, NSUInteger mountedCount, NSUInteger unmountedCount)
+{
+  NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:1];
+  while ([lifeManager lastMountStatistics].mountedCount != mountedCount
+         || [lifeManager lastMountStatistics].unmountedCount != unmountedCount) {
+    if ([timeout timeIntervalSinceNow] < 0) {
+      return NO;
+    }
+    [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  }
+  return YES;
+}
+
+- (void)testMountingIncrementallyMountsAndUnmountsLikeARegularMount
+{
+  CKComponentLifecycleManager *lifeManager = [[CKComponentLifecycleManager alloc] initWithComponentProvider:[self class]];
+  lifeManager.mountsIncrementally = YES;
+  [lifeManager updateWithState:[lifeManager prepareForUpdateWithModel:[UIColor redColor] constrainedSize:size context:nil]];
+
+  UIView *view = [[UIView alloc] initWithFrame:CGRectMake(0.0, 0.0, 40.0, 40.0)];
+  [lifeManager attachToView:view];
+  XCTAssertTrue(waitForMountStatistics(lifeManager, 2, 0));
+  XCTAssertEqualObjects([[view.subviews firstObject] backgroundColor], [UIColor redColor]);
+
+  [lifeManager updateWithState:[lifeManager prepareForUpdateWithModel:[UIColor greenColor] constrainedSize:size context:nil]];
+  XCTAssertTrue(waitForMountStatistics(lifeManager, 2, 2), @"Expected the previous pass to be unmounted once finished");
+  XCTAssertEqualObjects([[view.subviews firstObject] backgroundColor], [UIColor greenColor]);
+
+  [lifeManager detachFromView];
+  XCTAssertEqual([lifeManager lastMountStatistics].unmountedCount, 2u);
+}
+
 - (void)testNotifyingControllerThroughLifecycleManager
 {
   notified = NO;
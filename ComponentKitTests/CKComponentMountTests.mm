@@ -11,6 +11,7 @@
 #import <XCTest/XCTest.h>
 
 #import "CKComponent.h"
+#import "CKComponentIncrementalMount.h"
 #import "CKComponentInternal.h"
 #import "CKComponentLayout.h"
 #import "CKComponentSubclass.h"
@@ -22,6 +23,10 @@
 + (instancetype)newWithChild:(CKComponent *)child;
 @end
 
+@interface CKCenterCountingView : UIView
+@property (nonatomic, assign) NSUInteger setCenterCount;
+@end
+
 @implementation CKComponentMountTests
 
 - (void)testThatMountingComponentThatReturnsMountChildrenNoDoesNotMountItsChild
@@ -45,6 +50,84 @@
   }
 }
 
+- (void)testThatRemountingAnEquivalentComponentInTheSamePlaceDoesNotRepositionItsView
+{
+  UIView *view = [UIView new];
+  CKComponent *c1 = [CKComponent newWithView:{[CKCenterCountingView class]} size:{}];
+  NSSet *mountedComponents1 = CKMountComponentLayout([c1 layoutThatFits:{{50, 50}, {50, 50}} parentSize:{NAN, NAN}], view);
+
+  CKCenterCountingView *mountedView = [[view subviews] firstObject];
+  XCTAssertEqual(mountedView.setCenterCount, 1u);
+
+  CKComponent *c2 = [CKComponent newWithView:{[CKCenterCountingView class]} size:{}];
+  NSSet *mountedComponents2 = CKMountComponentLayout([c2 layoutThatFits:{{50, 50}, {50, 50}} parentSize:{NAN, NAN}], view);
+
+  XCTAssertEqual([[view subviews] firstObject], mountedView, @"Expected the view to be recycled");
+  XCTAssertEqual(mountedView.setCenterCount, 1u, @"Expected the recycled view not to be repositioned");
+
+  for (CKComponent *component in [mountedComponents1 setByAddingObjectsFromSet:mountedComponents2]) {
+    [component unmount];
+  }
+}
+
+- (void)testThatIncrementalMountMountsOnScreenSubtreesFirstWithoutReorderingViews
+{
+  CKComponent *root = [CKComponent newWithView:{[UIView class]} size:{}];
+  CKComponent *offscreenChild = [CKComponent newWithView:{[UIView class]} size:{}];
+  CKComponent *offscreenGrandchild = [CKComponent newWithView:{[UIView class]} size:{}];
+  CKComponent *onscreenChild = [CKComponent newWithView:{[UIView class]} size:{}];
+  CKComponent *onscreenGrandchild = [CKComponent newWithView:{[UIView class]} size:{}];
+  const CKComponentLayout layout = {root, {100, 2000}, {
+    {{0, 1000}, {offscreenChild, {100, 100}, {{{0, 0}, {offscreenGrandchild, {10, 10}}}}}},
+    {{0, 0}, {onscreenChild, {100, 100}, {{{0, 0}, {onscreenGrandchild, {10, 10}}}}}},
+  }};
+
+  UIView *view = [UIView new];
+  CKComponentIncrementalMount mount(layout, view, {{0, 0}, {100, 500}});
+  NSUInteger slices = 0;
+  while (!mount.mountUntil(0)) {
+    slices++;
+  }
+  XCTAssertEqual(slices, 4u, @"Expected one component to be mounted per slice when the deadline has passed");
+
+  std::vector<CKComponent *> expectedOrder = {root, offscreenChild, onscreenChild, onscreenGrandchild, offscreenGrandchild};
+  XCTAssertTrue(mount.mountedComponents() == expectedOrder, @"Expected the off-screen grandchild to be mounted last");
+
+  UIView *rootView = [[view subviews] firstObject];
+  XCTAssertTrue([rootView subviews][0] == offscreenChild.viewContext.view, @"Expected views to stay in component order");
+  XCTAssertTrue([rootView subviews][1] == onscreenChild.viewContext.view);
+
+  for (CKComponent *component : mount.mountedComponents()) {
+    [component unmount];
+  }
+}
+
+- (void)testThatIncrementalMountCallsCompletionOnceFinished
+{
+  CKComponent *c = [CKComponent newWithView:{[UIView class]} size:{}];
+  UIView *view = [UIView new];
+  __block NSUInteger mountedCount = 0;
+  std::shared_ptr<CKComponentIncrementalMount> mount =
+  CKMountComponentLayoutIncrementally([c layoutThatFits:{{50, 50}, {50, 50}} parentSize:{NAN, NAN}], view, 1, CGRectNull,
+                                      ^(const CKComponentIncrementalMount &m) {
+                                        mountedCount = m.mountedComponents().size();
+                                      });
+  XCTAssertTrue(mount->isFinished());
+  XCTAssertEqual(mountedCount, 1u);
+  XCTAssertEqual(c.mountGeneration, mount->mountGeneration());
+  [c unmount];
+}
+
+@end
+
+@implementation CKCenterCountingView
+
+- (void)setCenter:(CGPoint)center
+{
+  _setCenterCount++;
+  [super setCenter:center];
+}
+
 @end
 
 @implementation CKDontMountChildrenComponent
@@ -14,6 +14,7 @@
 #import "CKComponent.h"
 #import "CKComponentLifecycleManager.h"
 #import "CKComponentSubclass.h"
+#import "ComponentViewManager.h"
 
 @interface CKComponentViewAttributeTests : XCTestCase
 @end
@@ -43,6 +44,102 @@
   XCTAssertTrue([c isSelected], @"Expected selected to be applied to view");
 }
 
+- (void)testThatSettersPreparedOnABackgroundThreadCanBeAppliedOnTheMainThread
+{
+  dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    CKComponentViewAttributePrepareSetter([UIView class], @selector(setAlpha:));
+    CKComponentViewAttributePrepareSetter([UIView class], @selector(setFrame:));
+    CKComponentViewAttributePrepareSetter([CALayer class], @selector(setBorderColor:));
+  });
+
+  UIView *view = [[UIView alloc] init];
+  CKComponentViewAttribute(@selector(setAlpha:)).applicator(view, @0.5);
+  CKComponentViewAttribute(@selector(setFrame:)).applicator(view, [NSValue valueWithCGRect:CGRectMake(1, 2, 3, 4)]);
+  CKComponentViewAttribute::LayerAttribute(@selector(setBorderColor:)).applicator(view, (id)[UIColor redColor].CGColor);
+
+  XCTAssertEqualWithAccuracy(view.alpha, 0.5, 0.001);
+  XCTAssertTrue(CGRectEqualToRect(view.frame, CGRectMake(1, 2, 3, 4)));
+  XCTAssertTrue(CGColorEqualToColor(view.layer.borderColor, [UIColor redColor].CGColor));
+}
+
+- (void)testApplyingAValueOfTheWrongTypeToAStructSetterAsserts
+{
+  UIView *view = [[UIView alloc] init];
+  XCTAssertThrows(CKComponentViewAttribute(@selector(setFrame:)).applicator(view, @1));
+  XCTAssertThrows(CKComponentViewAttribute(@selector(setFrame:)).applicator(view, [NSValue valueWithCGPoint:CGPointZero]));
+}
+
+- (void)testThatMountingViewWithTypedAttributeActuallyAppliesAttributeToView
+{
+  CKComponent *testComponent = [CKComponent newWithView:{[UIView class], {
+    CKComponentViewAttributeWithValue<CGFloat>(@selector(setAlpha:), 0.5),
+    // Mounting resizes the view to its layout but leaves the bounds origin alone.
+    CKComponentViewAttributeWithValue<CGRect>(@selector(setBounds:), CGRectMake(3, 4, 0, 0)),
+    CKComponentViewAttributeWithValue<BOOL>(@selector(setUserInteractionEnabled:), NO),
+  }} size:{}];
+  CKComponentLifecycleManager *m = [[CKComponentLifecycleManager alloc] init];
+  [m updateWithState:{
+    .layout = [testComponent layoutThatFits:{{0, 0}, {10, 10}} parentSize:kCKComponentParentSizeUndefined]
+  }];
+
+  UIView *container = [[UIView alloc] init];
+  [m attachToView:container];
+  UIView *v = [[container subviews] firstObject];
+  XCTAssertEqualWithAccuracy(v.alpha, 0.5, 0.001, @"Expected alpha to be applied to view");
+  XCTAssertFalse(v.userInteractionEnabled, @"Expected userInteractionEnabled to be applied to view");
+  XCTAssertTrue(CGPointEqualToPoint(v.bounds.origin, CGPointMake(3, 4)), @"Expected bounds to be applied to view");
+}
+
+- (void)testThatTypedAttributeValuesAreComparedByValue
+{
+  const CKComponentViewAttributeValue a = CKComponentViewAttributeWithValue<CGFloat>(@selector(setAlpha:), 0.5);
+  const CKComponentViewAttributeValue b = CKComponentViewAttributeWithValue<CGFloat>(@selector(setAlpha:), 0.5);
+  const CKComponentViewAttributeValue c = CKComponentViewAttributeWithValue<CGFloat>(@selector(setAlpha:), 0.25);
+  XCTAssertTrue(a.first == CKComponentViewAttribute(@selector(setAlpha:)));
+  XCTAssertEqualObjects(a.second, b.second);
+  XCTAssertNotEqualObjects(a.second, c.second);
+
+  const CKComponentViewAttributeValue rect = CKComponentViewAttributeWithValue<CGRect>(@selector(setBounds:), CGRectMake(0, 0, 1, 2));
+  XCTAssertEqualObjects(rect.second, CKComponentViewAttributeWithValue<CGRect>(@selector(setBounds:), CGRectMake(0, 0, 1, 2)).second);
+  XCTAssertNotEqualObjects(rect.second, CKComponentViewAttributeWithValue<CGRect>(@selector(setBounds:), CGRectMake(0, 0, 2, 1)).second);
+  // Both are eight zero bytes on 64-bit, so only their types tell them apart.
+  XCTAssertNotEqualObjects(CKComponentViewAttributeWithValue<CGFloat>(@selector(setAlpha:), 0).second,
+                           CKComponentViewAttributeWithValue<NSInteger>(@selector(setTag:), 0).second,
+                           @"Expected values of different types not to be equal");
+}
+
+- (void)testAttributeValueMapLookupAndInsertion
+{
+  CKViewComponentAttributeValueMap map = {
+    {@selector(setAlpha:), @0.5},
+    {@selector(setBackgroundColor:), [UIColor blueColor]},
+    {@selector(setAlpha:), @1},
+  };
+  XCTAssertEqual(map.size(), 2u, @"Expected duplicate attributes to be ignored");
+  XCTAssertEqualObjects(map.find(@selector(setAlpha:))->second, @0.5, @"Expected the first value for an attribute to win");
+  XCTAssertTrue(map.find(@selector(setHidden:)) == map.end());
+
+  XCTAssertFalse(map.insert({@selector(setBackgroundColor:), [UIColor redColor]}).second);
+  map[@selector(setHidden:)] = @YES;
+  map.insert({
+    {@selector(setTag:), @1},
+    {@selector(setClipsToBounds:), @YES},
+    {@selector(setOpaque:), @NO},
+  });
+  XCTAssertEqual(map.size(), 6u, @"Expected map to grow beyond its inline capacity");
+  XCTAssertEqualObjects(map.find(@selector(setBackgroundColor:))->second, [UIColor blueColor]);
+  XCTAssertEqualObjects(map.find(@selector(setHidden:))->second, @YES);
+
+  CKViewComponentAttributeValueMap copied = map;
+  CKViewComponentAttributeValueMap moved = std::move(map);
+  XCTAssertEqual(moved.size(), 6u);
+  XCTAssertEqual(copied.size(), 6u);
+  XCTAssertEqualObjects(copied.find(@selector(setOpaque:))->second, @NO);
+  for (auto it = moved.begin(), prev = moved.end(); it != moved.end(); prev = it++) {
+    XCTAssertTrue(prev == moved.end() || prev->first.internedIdentifier < it->first.internedIdentifier, @"Expected attributes to be sorted");
+  }
+}
+
 - (void)testThatRecyclingViewWithSameAttributeValueDoesNotReApplyAttributeToView
 {
   CKComponent *testComponent1 = [CKComponent newWithView:{[CKSetterCounterView class], {
@@ -73,6 +170,66 @@
   XCTAssertEqualObjects([c backgroundColor], [UIColor redColor], @"Expected background color to be updated by m2");
 }
 
+- (void)testThatRecyclingViewWithSameAttributeValueIsCountedAsSkipped
+{
+  CKComponent *testComponent1 = [CKComponent newWithView:{[UIView class], {
+    {@selector(setAlpha:), @0.5},
+    {@selector(setBackgroundColor:), [UIColor blueColor]},
+  }} size:{}];
+  CKComponentLifecycleManager *m1 = [[CKComponentLifecycleManager alloc] init];
+  [m1 updateWithState:{
+    .layout = [testComponent1 layoutThatFits:{{0, 0}, {10, 10}} parentSize:kCKComponentParentSizeUndefined]
+  }];
+
+  UIView *container = [[UIView alloc] init];
+  CK::Component::AttributeApplicator::resetStatistics();
+  [m1 attachToView:container];
+  XCTAssertEqual(CK::Component::AttributeApplicator::statistics().appliedCount, 2u);
+  XCTAssertEqual(CK::Component::AttributeApplicator::statistics().skippedCount, 0u);
+
+  CKComponent *testComponent2 = [CKComponent newWithView:{[UIView class], {
+    {@selector(setAlpha:), @0.5},
+    {@selector(setBackgroundColor:), [UIColor redColor]},
+  }} size:{}];
+  CKComponentLifecycleManager *m2 = [[CKComponentLifecycleManager alloc] init];
+  [m2 updateWithState:{
+    .layout = [testComponent2 layoutThatFits:{{0, 0}, {10, 10}} parentSize:kCKComponentParentSizeUndefined]
+  }];
+  CK::Component::AttributeApplicator::resetStatistics();
+  [m2 attachToView:container];
+
+  const CK::Component::AttributeApplicator::Statistics statistics = CK::Component::AttributeApplicator::statistics();
+  XCTAssertEqual(statistics.appliedCount, 1u, @"Expected only the changed background color to be applied");
+  XCTAssertEqual(statistics.skippedCount, 1u, @"Expected the unchanged alpha to be skipped");
+  XCTAssertEqualWithAccuracy(statistics.skipRate(), 0.5, 0.001);
+}
+
+- (void)testThatEqualViewConfigurationsShareAttributes
+{
+  CKComponentViewConfiguration config1 = {[UIView class], {
+    {@selector(setAlpha:), @0.5},
+    {@selector(setBackgroundColor:), [UIColor blueColor]},
+  }};
+  CKComponentViewConfiguration config2 = {[UIView class], {
+    {@selector(setBackgroundColor:), [UIColor blueColor]},
+    {@selector(setAlpha:), @0.5},
+  }};
+  CKComponentViewConfiguration config3 = {[UIView class], {
+    {@selector(setAlpha:), @0.5},
+    {@selector(setBackgroundColor:), [UIColor redColor]},
+  }};
+  XCTAssertTrue(config1.attributes() == config2.attributes(), @"Expected equal configurations to be interned");
+  XCTAssertTrue(config1 == config2);
+  XCTAssertFalse(config1.attributes() == config3.attributes(), @"Did not expect configurations with distinct values to be interned together");
+  XCTAssertFalse(config1 == config3);
+
+  CKComponentViewConfiguration accessibleConfig = {[UIView class], {
+    {@selector(setAlpha:), @0.5},
+    {@selector(setBackgroundColor:), [UIColor blueColor]},
+  }, {.accessibilityIdentifier = @"test"}};
+  XCTAssertFalse(config1.attributes() == accessibleConfig.attributes(), @"Configurations with an accessibility context are not interned");
+}
+
 - (void)testThatRecyclingViewWithDistinctAttributeValueDoesNotHideAndReShowView
 {
   CKComponent *testComponent1 = [CKComponent newWithView:{[CKHidingCounterView class], {
@@ -225,6 +382,33 @@
   XCTAssertEqual(updateCount, 0u, @"Nothing should be updated");
 }
 
+#pragma mark - Performance
+
+static const NSUInteger kAttributeApplicationIterations = 10000;
+
+- (void)testBoxedAttributeApplicationPerformance
+{
+  UIView *view = [[UIView alloc] init];
+  const CKComponentViewAttribute attribute(@selector(setAlpha:));
+  NSNumber *value = @0.5;
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < kAttributeApplicationIterations; i++) {
+      attribute.applicator(view, value);
+    }
+  }];
+}
+
+- (void)testTypedAttributeApplicationPerformance
+{
+  UIView *view = [[UIView alloc] init];
+  const CKComponentViewAttributeValue attributeValue = CKComponentViewAttributeWithValue<CGFloat>(@selector(setAlpha:), 0.5);
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < kAttributeApplicationIterations; i++) {
+      attributeValue.first.applicator(view, attributeValue.second);
+    }
+  }];
+}
+
 @end
 
 @implementation CKSetterCounterView
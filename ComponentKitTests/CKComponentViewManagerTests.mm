@@ -123,6 +123,67 @@ static NSArray *arrayByPerformingBlock(NSArray *array, id (^block)(id))
   XCTAssertEqual(container.numberOfSubviewsAdded, 2u, @"Expected exactly two subviews to be added");
 }
 
+static std::vector<CKComponentViewConfiguration> distinctViewConfigurations(NSUInteger count)
+{
+  std::vector<CKComponentViewConfiguration> configurations;
+  for (NSUInteger i = 0; i < count; i++) {
+    configurations.push_back({CKComponentViewClass("CKDistinctView" + std::to_string(i), ^{ return [[UIView alloc] init]; })});
+  }
+  return configurations;
+}
+
+static NSArray *mountDistinctViews(UIView *container,
+                                   const std::vector<CKComponentViewConfiguration> &configurations,
+                                   const std::vector<NSUInteger> &order)
+{
+  NSMutableArray *views = [NSMutableArray array];
+  ViewManager m(container);
+  for (NSUInteger i : order) {
+    [views addObject:m.viewForConfiguration([CKComponent class], configurations[i])];
+  }
+  return views;
+}
+
+- (void)testThatComponentViewManagerReordersViewsIfOrderShuffled
+{
+  const auto configurations = distinctViewConfigurations(20);
+  std::vector<NSUInteger> order;
+  for (NSUInteger i = 0; i < configurations.size(); i++) {
+    order.push_back(i);
+  }
+
+  UIView *container = [[UIView alloc] init];
+  CK::Component::ViewReuseUtilities::mountingInRootView(container);
+  mountDistinctViews(container, configurations, order);
+
+  // Mount a subset, in a different order, so that hidden views are interleaved with vended ones.
+  std::vector<NSUInteger> shuffledOrder = {19, 3, 4, 5, 0, 17, 8, 9, 1, 12, 11, 10};
+  NSArray *vendedViews = mountDistinctViews(container, configurations, shuffledOrder);
+  NSArray *visibleSubviews = [[container subviews] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"hidden == NO"]];
+  XCTAssertEqualObjects(visibleSubviews, vendedViews, @"Expected subviews to be in the order they were vended");
+}
+
+- (void)testReorderingPerformanceWithManyVendedViews
+{
+  const auto configurations = distinctViewConfigurations(500);
+  std::vector<NSUInteger> order;
+  for (NSUInteger i = 0; i < configurations.size(); i++) {
+    order.push_back(i);
+  }
+  std::vector<NSUInteger> reversedOrder(order.rbegin(), order.rend());
+
+  UIView *container = [[UIView alloc] init];
+  CK::Component::ViewReuseUtilities::mountingInRootView(container);
+  mountDistinctViews(container, configurations, order);
+
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 5; i++) {
+      mountDistinctViews(container, configurations, reversedOrder);
+      mountDistinctViews(container, configurations, order);
+    }
+  }];
+}
+
 - (void)testThatGettingRecycledViewForComponentDoesNotRecycleViewWithDisjointAttributes
 {
   CKComponent *bgColorComponent =
@@ -151,6 +212,121 @@ static NSArray *arrayByPerformingBlock(NSArray *array, id (^block)(id))
   }
 }
 
+- (void)testThatGettingRecycledViewForComponentIgnoresOrderOfAttributes
+{
+  CKComponent *component1 =
+  [CKComponent newWithView:{[UIView class], {
+    {@selector(setBackgroundColor:), [UIColor blueColor]},
+    {@selector(setAlpha:), @0.5},
+  }} size:{}];
+
+  UIView *container = [[UIView alloc] init];
+  CK::Component::ViewReuseUtilities::mountingInRootView(container);
+  UIView *subview;
+
+  {
+    ViewManager m(container);
+    subview = m.viewForConfiguration([component1 class], [component1 viewConfiguration]);
+  }
+
+  CKComponent *component2 =
+  [CKComponent newWithView:{[UIView class], {
+    {@selector(setAlpha:), @0.25},
+    {@selector(setBackgroundColor:), [UIColor redColor]},
+  }} size:{}];
+
+  {
+    ViewManager m(container);
+    XCTAssertTrue(subview == m.viewForConfiguration([component2 class], [component2 viewConfiguration]), @"Expected the view to be recycled since both components have the same attribute identifiers");
+  }
+}
+
+- (void)testThatEqualViewClassesAndAttributesShareInternedIdentifiers
+{
+  CKComponentViewClass viewClass1([UIView class]);
+  CKComponentViewClass viewClass2([UIView class]);
+  CKComponentViewClass imageViewClass([UIImageView class]);
+  XCTAssertEqual(viewClass1.getInternedIdentifier(), viewClass2.getInternedIdentifier());
+  XCTAssertNotEqual(viewClass1.getInternedIdentifier(), imageViewClass.getInternedIdentifier());
+
+  CKComponentViewAttribute alpha1(@selector(setAlpha:));
+  CKComponentViewAttribute alpha2("setAlpha:", ^(id view, id value){});
+  CKComponentViewAttribute hidden(@selector(setHidden:));
+  XCTAssertEqual(alpha1.internedIdentifier, alpha2.internedIdentifier);
+  XCTAssertTrue(alpha1 == alpha2);
+  XCTAssertFalse(alpha1 == hidden);
+}
+
+- (void)testThatPrewarmedViewsAreHiddenAndThenVendedWithoutMisses
+{
+  CKComponent *component = [CKComponent newWithView:{[UIView class], {{@selector(setAlpha:), @0.5}}} size:{}];
+
+  UIView *container = [[UIView alloc] init];
+  CK::Component::ViewReuseUtilities::mountingInRootView(container);
+  CK::Component::ViewReusePoolMap::resetStatistics();
+  CK::Component::ViewReusePoolMap::viewReusePoolMapForView(container).prewarm([component class], [component viewConfiguration], container, 2);
+  XCTAssertEqual([[container subviews] count], 2u, @"Expected two views to be prewarmed");
+  XCTAssertTrue([[container subviews][0] isHidden] && [[container subviews][1] isHidden], @"Expected prewarmed views to be hidden");
+
+  {
+    ViewManager m(container);
+    XCTAssertTrue([container subviews][0] == m.viewForConfiguration([component class], [component viewConfiguration]));
+    XCTAssertTrue([container subviews][1] == m.viewForConfiguration([component class], [component viewConfiguration]));
+    m.viewForConfiguration([component class], [component viewConfiguration]);
+  }
+  XCTAssertEqual([[container subviews] count], 3u);
+
+  NSUInteger missCount = 0;
+  NSUInteger peakVendedCount = 0;
+  for (const auto &it : CK::Component::ViewReusePoolMap::statistics()) {
+    if (it.first.componentClass == [component class]) {
+      missCount += it.second.missCount;
+      peakVendedCount = MAX(peakVendedCount, it.second.peakVendedCount);
+    }
+  }
+  XCTAssertEqual(missCount, 1u, @"Expected only the view beyond the prewarmed ones to be a miss");
+  XCTAssertEqual(peakVendedCount, 3u);
+
+  UIView *otherContainer = [[UIView alloc] init];
+  CK::Component::ViewReuseUtilities::mountingInRootView(otherContainer);
+  CK::Component::ViewReusePoolMap::viewReusePoolMapForView(otherContainer).prewarm([component class], [component viewConfiguration], otherContainer);
+  XCTAssertEqual([[otherContainer subviews] count], 3u, @"Expected prewarming to use the observed peak");
+}
+
+- (void)testThatSharedViewReusePoolMovesHiddenViewsBetweenContainers
+{
+  CK::Component::SharedViewReusePool::setMaximumViewsPerKey(1);
+  CKComponent *component = [CKComponent newWithView:{[UIView class], {{@selector(setAlpha:), @0.25}}} size:{}];
+
+  UIView *container1 = [[UIView alloc] init];
+  CK::Component::ViewReuseUtilities::mountingInRootView(container1);
+  UIView *subview1;
+  UIView *subview2;
+  {
+    ViewManager m(container1);
+    subview1 = m.viewForConfiguration([component class], [component viewConfiguration]);
+    subview2 = m.viewForConfiguration([component class], [component viewConfiguration]);
+  }
+  {
+    ViewManager m(container1);
+  }
+  XCTAssertTrue(subview1.superview == container1 && subview1.hidden, @"Expected the view beyond the cap to stay hidden in its container");
+  XCTAssertNil(subview2.superview, @"Expected the hidden view to be moved to the shared pool");
+  XCTAssertEqual(CK::Component::SharedViewReusePool::viewCount(), 1u);
+
+  UIView *container2 = [[UIView alloc] init];
+  CK::Component::ViewReuseUtilities::mountingInRootView(container2);
+  {
+    ViewManager m(container2);
+    XCTAssertTrue(subview2 == m.viewForConfiguration([component class], [component viewConfiguration]), @"Expected the shared view to be vended to another container");
+  }
+  XCTAssertTrue(subview2.superview == container2);
+  XCTAssertFalse(subview2.hidden);
+  XCTAssertEqual(CK::Component::SharedViewReusePool::viewCount(), 0u);
+
+  CK::Component::SharedViewReusePool::setMaximumViewsPerKey(0);
+}
+
 - (void)testThatGettingViewForViewComponentWithNilViewClassCallsClassMethodNewView
 {
   CKComponentViewClass customClass("customimage", ^{ return [[UIImageView alloc] init]; });
@@ -12,9 +12,54 @@
 
 #import <ComponentKit/CKCompositeComponent.h>
 
+#import "CKComponentController.h"
 #import "CKComponentScopeFrame.h"
 #import "CKThreadLocalComponentScope.h"
 
+@interface CKAnnouncementCountingController : CKComponentController
+@property (nonatomic, assign) NSUInteger willAppearCount;
+@property (nonatomic, assign) NSUInteger didDisappearCount;
+@end
+
+@implementation CKAnnouncementCountingController
+- (void)componentTreeWillAppear
+{
+  [super componentTreeWillAppear];
+  _willAppearCount++;
+}
+- (void)componentTreeDidDisappear
+{
+  [super componentTreeDidDisappear];
+  _didDisappearCount++;
+}
+@end
+
+/** Only overrides one of the announceable events, so it should only be registered for that one. */
+@interface CKWillAppearOnlyController : CKComponentController
+@property (nonatomic, assign) NSUInteger willAppearCount;
+/** Every selector announced to the controller, including ones it only inherits. */
+@property (nonatomic, strong, readonly) NSMutableArray *announcedSelectors;
+@end
+
+@implementation CKWillAppearOnlyController
+- (void)componentTreeWillAppear
+{
+  [super componentTreeWillAppear];
+  _willAppearCount++;
+}
+- (id)performSelector:(SEL)aSelector
+{
+  if (!_announcedSelectors) {
+    _announcedSelectors = [NSMutableArray array];
+  }
+  [_announcedSelectors addObject:NSStringFromSelector(aSelector)];
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
+  return [super performSelector:aSelector];
+#pragma clang diagnostic pop
+}
+@end
+
 @interface CKComponentScopeTests : XCTestCase
 @end
 
@@ -289,4 +334,69 @@
   XCTAssertTrue(CKThreadLocalComponentScope::cursor()->empty());
 }
 
+- (void)testCursorSupportsTreesDeeperThanItsInitialCapacity
+{
+  CKComponentScopeFrame *frame = [CKComponentScopeFrame rootFrameWithListener:nil];
+  CKThreadLocalComponentScope threadScope(nil, frame);
+  CKComponentScopeCursor *cursor = CKThreadLocalComponentScope::cursor();
+
+  NSMutableArray *frames = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 1000; i++) {
+    CKComponentScopeFrame *child = [cursor->currentFrame() childFrameWithComponentClass:[CKCompositeComponent class]
+                                                                             identifier:nil
+                                                                                  state:nil
+                                                                             controller:nil];
+    cursor->pushFrameAndEquivalentPreviousFrame(child, nil);
+    [frames addObject:child];
+  }
+  for (CKComponentScopeFrame *child in [frames reverseObjectEnumerator]) {
+    XCTAssertEqual(cursor->currentFrame(), child);
+    cursor->popFrame();
+  }
+  XCTAssertNotEqual(cursor->currentFrame(), (CKComponentScopeFrame *)nil);
+}
+
+#pragma mark - Performance
+
+- (void)testScopePushAndPopPerformance
+{
+  CKComponentScopeFrame *frame = [CKComponentScopeFrame rootFrameWithListener:nil];
+  CKThreadLocalComponentScope threadScope(nil, frame);
+  CKComponentScopeFrame *rootFrame = CKThreadLocalComponentScope::cursor()->currentFrame();
+
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 100000; i++) {
+      CKThreadLocalComponentScope::cursor()->pushFrameAndEquivalentPreviousFrame(rootFrame, nil);
+      CKThreadLocalComponentScope::cursor()->popFrame();
+    }
+  }];
+}
+
+- (void)testAnnouncingEventsReachesEveryRegisteredControllerOnce
+{
+  CKComponentScopeFrame *root = [CKComponentScopeFrame rootFrameWithListener:nil];
+  CKAnnouncementCountingController *first = [[CKAnnouncementCountingController alloc] init];
+  CKAnnouncementCountingController *second = [[CKAnnouncementCountingController alloc] init];
+  CKWillAppearOnlyController *third = [[CKWillAppearOnlyController alloc] init];
+
+  CKComponentScopeFrame *child = [root childFrameWithComponentClass:[CKCompositeComponent class]
+                                                         identifier:@"first"
+                                                              state:nil
+                                                         controller:first];
+  [child childFrameWithComponentClass:[CKCompositeComponent class] identifier:@"second" state:nil controller:second];
+  [root childFrameWithComponentClass:[CKCompositeComponent class] identifier:@"third" state:nil controller:third];
+
+  [root announceEventToControllers:@selector(componentTreeWillAppear)];
+  XCTAssertEqual(first.willAppearCount, 1u);
+  XCTAssertEqual(second.willAppearCount, 1u);
+  XCTAssertEqual(third.willAppearCount, 1u);
+
+  [root announceEventToControllers:@selector(componentTreeDidDisappear)];
+  XCTAssertEqual(first.didDisappearCount, 1u);
+  XCTAssertEqual(second.didDisappearCount, 1u);
+  XCTAssertEqual(first.willAppearCount, 1u);
+  XCTAssertEqualObjects(third.announcedSelectors, @[NSStringFromSelector(@selector(componentTreeWillAppear))],
+                        @"A controller that does not override an event should not be registered for it");
+}
+
 @end
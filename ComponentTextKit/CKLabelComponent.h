@@ -59,6 +59,8 @@ struct CKLabelAttributes
  generates the corresponding attributed string from the attribute struct you provide and configures the text component
  for you.
    
+ Labels are typically short and repeated, so consider creating them with a CKTextComponentGlyphAtlas in context.
+
  @see CKTextComponent for advanced text usages like link tapping.
  
  @param attributes The content and styling information for the text component.
@@ -11,6 +11,7 @@
 #import <ComponentKit/CKComponent.h>
 
 #import <ComponentKit/CKTextKitAttributes.h>
+#import <ComponentKit/CKTextKitMeasurementCache.h>
 
 struct CKTextComponentAccessibilityContext
 {
@@ -30,3 +31,10 @@ struct CKTextComponentAccessibilityContext
                  accessibilityContext:(const CKTextComponentAccessibilityContext &)accessibilityContext;
 
 @end
+
+/** How often text component layout was answered from earlier measurements instead of a new TextKit layout. */
+CK::TextKit::Measurement::Statistics CKTextComponentMeasurementStatistics();
+void CKTextComponentResetMeasurementStatistics();
+
+/** The estimated bytes retained by the renderers cached for text components, and the current budget for them. */
+CK::TextKit::Renderer::Usage CKTextComponentRendererCacheUsage();
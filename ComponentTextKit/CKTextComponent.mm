@@ -13,19 +13,26 @@
 #import <memory>
 #import <vector>
 
+#import <ComponentKit/CKComponentContext.h>
 #import <ComponentKit/CKComponentInternal.h>
 
 #import <ComponentKit/CKTextKitRenderer.h>
+#import <ComponentKit/CKTextKitMeasurementCache.h>
 #import <ComponentKit/CKTextKitRendererCache.h>
 
 #import <ComponentKit/CKInternalHelpers.h>
 
+#import "CKTextComponentGlyphAtlas.h"
+#import "CKTextComponentLayer.h"
+#import "CKTextComponentRasterizationBudget.h"
 #import "CKTextComponentView.h"
+#import "CKTextComponentViewInternal.h"
 
 static CK::TextKit::Renderer::Cache *sharedRendererCache()
 {
-  // This cache is sized arbitrarily
-  static CK::TextKit::Renderer::Cache *__rendererCache (new CK::TextKit::Renderer::Cache("CKTextComponentRendererCache", 500, 0.2));
+  // Renderers are cached at their estimated cost in bytes. 4MB holds several screens worth of long posts, or thousands of
+  // short labels.
+  static CK::TextKit::Renderer::Cache *__rendererCache (new CK::TextKit::Renderer::Cache("CKTextComponentRendererCache", 4 * 1024 * 1024, 0.2));
   return __rendererCache;
 }
 
@@ -34,11 +41,12 @@ static CK::TextKit::Renderer::Cache *sharedRendererCache()
  This is to reduce memory load when loading thousands and thousands of text components into memory at once.  Instead
  we maintain a LRU renderer cache that is queried via stack-allocated keys.
  */
-static CKTextKitRenderer *rendererForAttributes(CKTextKitAttributes &attributes, CGSize constrainedSize)
+static CKTextKitRenderer *rendererForAttributes(CKTextKitAttributes &attributes, size_t attributesHash, CGSize constrainedSize)
 {
   CK::TextKit::Renderer::Cache *cache = sharedRendererCache();
   const CK::TextKit::Renderer::Key key {
     attributes,
+    attributesHash,
     constrainedSize
   };
 
@@ -49,16 +57,47 @@ static CKTextKitRenderer *rendererForAttributes(CKTextKitAttributes &attributes,
     [[CKTextKitRenderer alloc]
      initWithTextKitAttributes:attributes
      constrainedSize:constrainedSize];
-    cache->cacheObject(key, renderer, 1);
+    cache->cacheObject(key, renderer, renderer.estimatedCost);
   }
 
   return renderer;
 }
 
+static CK::TextKit::Measurement::Cache *sharedMeasurementCache()
+{
+  // Entries only hold a few sizes per string, so this can track many more strings than the renderer cache.
+  static CK::TextKit::Measurement::Cache *__measurementCache =
+  new CK::TextKit::Measurement::Cache("CKTextComponentMeasurementCache", 2000, 0.2, [](const CKTextKitAttributes &attributes, size_t attributesHash, CGSize constrainedSize) {
+    CKTextKitAttributes mutableAttributes = attributes;
+    return CK::TextKit::Measurement::resultForRenderer(rendererForAttributes(mutableAttributes, attributesHash, constrainedSize));
+  });
+  return __measurementCache;
+}
+
+CK::TextKit::Measurement::Statistics CKTextComponentMeasurementStatistics()
+{
+  return sharedMeasurementCache()->statistics();
+}
+
+void CKTextComponentResetMeasurementStatistics()
+{
+  sharedMeasurementCache()->resetStatistics();
+}
+
+CK::TextKit::Renderer::Usage CKTextComponentRendererCacheUsage()
+{
+  return sharedRendererCache()->usage();
+}
+
 @implementation CKTextComponent
 {
   CKTextKitAttributes _attributes;
+  /** Hashing walks the whole string, so it is done once here rather than for every cache key built from _attributes. */
+  size_t _attributesHash;
   CKTextComponentAccessibilityContext _accessibilityContext;
+  CKTextComponentRasterizationBudget *_rasterizationBudget;
+  CKTextComponentGlyphAtlas *_glyphAtlas;
+  UIColor *_backgroundColor;
 }
 
 + (instancetype)newWithTextAttributes:(const CKTextKitAttributes &)attributes
@@ -67,6 +106,9 @@ static CKTextKitRenderer *rendererForAttributes(CKTextKitAttributes &attributes,
 {
   CKTextKitAttributes copyAttributes = attributes.copy();
   CKViewComponentAttributeValueMap copiedMap = viewAttributes;
+  // Read before the map is moved into the view configuration.
+  const auto backgroundColorAttribute = copiedMap.find(@selector(setBackgroundColor:));
+  id backgroundColor = backgroundColorAttribute != copiedMap.end() ? backgroundColorAttribute->second : nil;
   CKTextComponent *c = [super newWithView:{
     [CKTextComponentView class],
     std::move(copiedMap),
@@ -79,22 +121,38 @@ static CKTextKitRenderer *rendererForAttributes(CKTextKitAttributes &attributes,
   } size:{}];
   if (c) {
     c->_attributes = copyAttributes;
+    c->_attributesHash = c->_attributes.hash();
     c->_accessibilityContext = accessibilityContext;
+    c->_rasterizationBudget = CKComponentContext<CKTextComponentRasterizationBudget>::get();
+    c->_glyphAtlas = CKComponentContext<CKTextComponentGlyphAtlas>::get();
+    if ([backgroundColor isKindOfClass:[UIColor class]]) {
+      c->_backgroundColor = backgroundColor;
+    }
   }
   return c;
 }
 
 - (CKComponentLayout)computeLayoutThatFits:(CKSizeRange)constrainedSize
 {
-  const CKTextKitRenderer *renderer = rendererForAttributes(_attributes, constrainedSize.max);
-  return {
-    self,
-    constrainedSize.clamp({
-      CKCeilPixelValue(renderer.size.width),
-      CKCeilPixelValue(renderer.size.height)
-    }),
-    {}
-  };
+  // Most constrained sizes a piece of text is measured at produce the same layout, so ask the measurement cache first
+  // and only build a renderer for this exact size if no earlier measurement covers it.
+  const CGSize measuredSize = sharedMeasurementCache()->sizeForAttributes(_attributes, _attributesHash, constrainedSize.max);
+  const CGSize size = constrainedSize.clamp({
+    CKCeilPixelValue(measuredSize.width),
+    CKCeilPixelValue(measuredSize.height)
+  });
+  // Parents such as stacks lay a child out several times at different sizes before settling on one, so only an exact
+  // size range is known to be the size the text will be mounted at; rasterizing at any other size would be wasted.
+  const BOOL sizeIsExact = CGSizeEqualToSize(constrainedSize.min, constrainedSize.max);
+  if (sizeIsExact && (_glyphAtlas || _rasterizationBudget)) {
+    CKTextKitRenderer *renderer = rendererForAttributes(_attributes, _attributesHash, size);
+    if (![_glyphAtlas glyphRunForRenderer:renderer boundsSize:size scale:CKScreenScale()] && _rasterizationBudget) {
+      [CKTextComponentLayer rasterizeRenderer:renderer
+                              backgroundColor:_backgroundColor
+                                       budget:_rasterizationBudget];
+    }
+  }
+  return {self, size, {}};
 }
 
 - (CK::Component::MountResult)mountInContext:(const CK::Component::MountContext &)context
@@ -107,7 +165,8 @@ static CKTextKitRenderer *rendererForAttributes(CKTextKitAttributes &attributes,
                                                    children:children
                                              supercomponent:supercomponent];
   CKTextComponentView *view = (CKTextComponentView *)result.contextForChildren.viewManager->view;
-  CKTextKitRenderer *renderer = rendererForAttributes(_attributes, size);
+  CKTextKitRenderer *renderer = rendererForAttributes(_attributes, _attributesHash, size);
+  view.textLayer.glyphAtlas = _glyphAtlas;
   view.renderer = renderer;
   return result;
 }
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <UIKit/UIKit.h>
+
+#import <ComponentKit/CKMacros.h>
+
+@class CKTextKitRenderer;
+
+struct CKTextComponentGlyphAtlasStatistics {
+  /** The number of distinct glyph runs rasterized into the atlas. */
+  NSUInteger runCount;
+  NSUInteger pageCount;
+  /** Bytes of bitmap held by the pages, regardless of how full they are, and by the runs of pages still being filled. */
+  NSUInteger retainedBytes;
+  NSUInteger hitCount;
+  NSUInteger missCount;
+};
+
+/** A glyph run rasterized into the atlas: an image to be used as layer contents and the part of it the run occupies. */
+@interface CKTextComponentGlyphRun : NSObject
+
+/** A CGImageRef of the whole page once the page is full, and of the run alone until then. */
+@property (nonatomic, strong, readonly) id image;
+
+/** The run's region of the image in the unit coordinate space of CALayer's contentsRect. */
+@property (nonatomic, assign, readonly) CGRect contentsRect;
+
+@end
+
+/**
+ Rasterizes short, single-style, single-line strings (timestamps, counts, button titles) once per font, color and scale
+ into shared atlas pages. Text layers showing such a string point their contents at the run's region of a page instead of
+ each drawing and caching a bitmap of their own, so a feed that repeats the same short strings holds one copy of their
+ pixels and draws nothing when a repeated string is displayed. A page is only shared once it is full; until then each of
+ its runs is handed out as an image of its own, so no layer ever shows a page that is still being drawn into.
+
+ Text components fill the atlas on the thread that lays them out whenever an atlas is in context and the size range is
+ exact. Layers only look runs up on the main thread and fill the atlas in the background on a miss.
+
+ Text that does not qualify, or that does not fit in the remaining pages, is drawn the regular way. Put an atlas in a
+ component context while creating the components that should use it; CKLabelComponent and CKTextComponent pick it up:
+
+ @example CKComponentContext<CKTextComponentGlyphAtlas> atlasContext(atlas);
+
+ The atlas is threadsafe and is emptied on memory warnings. Layers keep the page images they already show.
+ */
+@interface CKTextComponentGlyphAtlas : NSObject
+
+/**
+ @param pagePixelSize The width and height of each square page, in pixels.
+ @param maximumPageCount The number of pages after which new runs are no longer added to the atlas.
+ */
+- (instancetype)initWithPagePixelSize:(NSUInteger)pagePixelSize maximumPageCount:(NSUInteger)maximumPageCount;
+
+- (instancetype)init CK_NOT_DESIGNATED_INITIALIZER_ATTRIBUTE;
+
+/**
+ Returns the run for the renderer's text, rasterizing it into a page first if the atlas has not seen it yet. Returns nil
+ if the text is not a single short run, would not be drawn at the origin of bounds of the given size, or no longer fits.
+ */
+- (CKTextComponentGlyphRun *)glyphRunForRenderer:(CKTextKitRenderer *)renderer
+                                      boundsSize:(CGSize)boundsSize
+                                           scale:(CGFloat)scale;
+
+/** Whether the renderer's text is a single short run the atlas could hold, whether or not it has room left for it. */
+- (BOOL)canHoldRenderer:(CKTextKitRenderer *)renderer boundsSize:(CGSize)boundsSize;
+
+/** Like glyphRunForRenderer:boundsSize:scale:, but returns nil instead of rasterizing text the atlas has not seen. */
+- (CKTextComponentGlyphRun *)existingGlyphRunForRenderer:(CKTextKitRenderer *)renderer
+                                              boundsSize:(CGSize)boundsSize
+                                                   scale:(CGFloat)scale;
+
+- (CKTextComponentGlyphAtlasStatistics)statistics;
+
+- (void)removeAllRuns;
+
+@end
@@ -0,0 +1,443 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import "CKTextComponentGlyphAtlas.h"
+
+#import <mutex>
+#import <unordered_map>
+#import <vector>
+
+#import <ComponentKit/ComponentUtilities.h>
+#import <ComponentKit/CKTextKitRenderer.h>
+#import <ComponentKit/CKTextKitRendererCache.h>
+
+/** Longer strings are rarely repeated verbatim, so they are left to the raster contents cache. */
+static const NSUInteger kMaximumRunLength = 32;
+
+/** Pixels left empty between runs so that no run samples its neighbours. */
+static const NSUInteger kRunGutter = 1;
+
+@interface CKTextComponentGlyphRun ()
+- (instancetype)initWithImage:(id)image contentsRect:(CGRect)contentsRect;
+@end
+
+@implementation CKTextComponentGlyphRun
+
+- (instancetype)initWithImage:(id)image contentsRect:(CGRect)contentsRect
+{
+  if (self = [super init]) {
+    _image = image;
+    _contentsRect = contentsRect;
+  }
+  return self;
+}
+
+@end
+
+namespace CK {
+  namespace TextKit {
+    namespace GlyphAtlas {
+      struct StyleKey {
+        UIFont *font;
+        UIColor *color;
+        CGFloat scale;
+
+        bool operator==(const StyleKey &other) const
+        {
+          return scale == other.scale && CKObjectIsEqual(font, other.font) && CKObjectIsEqual(color, other.color);
+        }
+      };
+
+      struct StyleKeyHasher {
+        size_t operator()(const StyleKey &k) const
+        {
+          return [k.font hash] ^ ([k.color hash] << 1) ^ std::hash<CGFloat>()(k.scale);
+        }
+      };
+
+      /** The paragraph style and drawn size pin down where the glyphs of a run land in its region. */
+      struct RunKey {
+        NSString *string;
+        NSParagraphStyle *paragraphStyle;
+        CGSize size;
+
+        bool operator==(const RunKey &other) const
+        {
+          return CGSizeEqualToSize(size, other.size)
+          && [string isEqualToString:other.string]
+          && CKObjectIsEqual(paragraphStyle, other.paragraphStyle);
+        }
+      };
+
+      struct RunKeyHasher {
+        size_t operator()(const RunKey &k) const
+        {
+          return [k.string hash] ^ std::hash<CGFloat>()(k.size.width) ^ (std::hash<CGFloat>()(k.size.height) << 1);
+        }
+      };
+
+      struct Run {
+        size_t pageIndex;
+        CGRect pixelRect;
+        /** The run's own image, handed out while its page is still being written to; nil once the page is sealed. */
+        id image;
+      };
+
+      /** A row of runs of similar heights, filled from left to right. */
+      struct Shelf {
+        NSUInteger y;
+        NSUInteger height;
+        NSUInteger nextX;
+      };
+
+      /**
+       Runs are drawn into the open page of their scale. Once a run no longer fits, the page is sealed: its image is
+       taken once and its context released, so the image never has to copy pixels that are still being written to.
+       */
+      struct Page {
+        CGFloat scale;
+        /** NULL once the page is sealed. */
+        CGContextRef context;
+        /** Only set once the page is sealed. */
+        id image;
+        std::vector<Shelf> shelves;
+        NSUInteger nextShelfY;
+      };
+    }
+  }
+}
+
+using namespace CK::TextKit::GlyphAtlas;
+
+/** Single-line, single-style, untruncated text drawn from the origin of its bounds. */
+static BOOL rendererIsSingleGlyphRun(CKTextKitRenderer *renderer, CGSize boundsSize)
+{
+  const CKTextKitAttributes &attributes = renderer.attributes;
+  NSAttributedString *attributedString = attributes.attributedString;
+  const NSUInteger length = attributedString.length;
+  if (length == 0 || length > kMaximumRunLength) {
+    return NO;
+  }
+  NSRange effectiveRange;
+  NSDictionary *stringAttributes = [attributedString attributesAtIndex:0 effectiveRange:&effectiveRange];
+  if (effectiveRange.length != length) {
+    return NO;
+  }
+  for (NSString *name in stringAttributes) {
+    if (![name isEqualToString:NSFontAttributeName]
+        && ![name isEqualToString:NSForegroundColorAttributeName]
+        && ![name isEqualToString:NSParagraphStyleAttributeName]) {
+      return NO;
+    }
+  }
+  const BOOL drawsShadow = attributes.shadowOpacity != 0 && attributes.shadowColor != nil
+  && (attributes.shadowRadius != 0 || !CGSizeEqualToSize(attributes.shadowOffset, CGSizeZero));
+  if (drawsShadow) {
+    return NO;
+  }
+  const CGRect drawnRect = renderer.drawnRect;
+  return CGPointEqualToPoint(drawnRect.origin, CGPointZero)
+  && !CGSizeEqualToSize(drawnRect.size, CGSizeZero)
+  && drawnRect.size.width <= boundsSize.width
+  && drawnRect.size.height <= boundsSize.height
+  && renderer.lineCount == 1
+  && !renderer.isTruncated;
+}
+
+static CGContextRef newBitmapContext(NSUInteger pixelWidth, NSUInteger pixelHeight, CGFloat scale)
+{
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef context = CGBitmapContextCreate(NULL, pixelWidth, pixelHeight, 8, 0, colorSpace,
+                                               kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Host);
+  CGColorSpaceRelease(colorSpace);
+  if (context) {
+    // Draw in points from the top left, the way UIKit and the renderer expect.
+    CGContextTranslateCTM(context, 0, pixelHeight);
+    CGContextScaleCTM(context, scale, -scale);
+  }
+  return context;
+}
+
+/** Draws the renderer into a bitmap of its own, whose context is released so the image owns the pixels outright. */
+static id newRunImage(CKTextKitRenderer *renderer, NSUInteger pixelWidth, NSUInteger pixelHeight, CGFloat scale)
+{
+  CGContextRef context = newBitmapContext(pixelWidth, pixelHeight, scale);
+  if (!context) {
+    return nil;
+  }
+  [renderer drawInContext:context bounds:{CGPointZero, {pixelWidth / scale, pixelHeight / scale}}];
+  id image = CFBridgingRelease(CGBitmapContextCreateImage(context));
+  CGContextRelease(context);
+  return image;
+}
+
+static BOOL allocateRegionInPage(Page &page, NSUInteger pagePixelSize, NSUInteger width, NSUInteger height, CGPoint *origin)
+{
+  for (Shelf &shelf : page.shelves) {
+    // Only share shelves with runs of about the same height so that little of each shelf is wasted.
+    if (height <= shelf.height && height * 4 >= shelf.height * 3 && shelf.nextX + width <= pagePixelSize) {
+      *origin = {(CGFloat)shelf.nextX, (CGFloat)shelf.y};
+      shelf.nextX += width + kRunGutter;
+      return YES;
+    }
+  }
+  if (width > pagePixelSize || page.nextShelfY + height > pagePixelSize) {
+    return NO;
+  }
+  page.shelves.push_back({page.nextShelfY, height, width + kRunGutter});
+  *origin = {0, (CGFloat)page.nextShelfY};
+  page.nextShelfY += height + kRunGutter;
+  return YES;
+}
+
+@implementation CKTextComponentGlyphAtlas
+{
+  NSUInteger _pagePixelSize;
+  NSUInteger _maximumPageCount;
+  std::mutex _mutex;
+  std::unordered_map<StyleKey, std::unordered_map<RunKey, Run, RunKeyHasher>, StyleKeyHasher> _runsByStyle;
+  std::vector<Page> _pages;
+  NSUInteger _runCount;
+  /** Bytes held by the images of runs whose page is still open. */
+  NSUInteger _openRunBytes;
+  NSUInteger _hitCount;
+  NSUInteger _missCount;
+  CK::TextKit::ApplicationObserver *_applicationObserver;
+}
+
+- (instancetype)initWithPagePixelSize:(NSUInteger)pagePixelSize maximumPageCount:(NSUInteger)maximumPageCount
+{
+  if (self = [super init]) {
+    _pagePixelSize = pagePixelSize;
+    _maximumPageCount = maximumPageCount;
+    __weak CKTextComponentGlyphAtlas *weakSelf = self;
+    _applicationObserver = new CK::TextKit::ApplicationObserver([weakSelf] {
+      [weakSelf removeAllRuns];
+    }, [] {});
+  }
+  return self;
+}
+
+- (instancetype)init
+{
+  CK_NOT_DESIGNATED_INITIALIZER();
+}
+
+- (void)dealloc
+{
+  delete _applicationObserver;
+  [self _releasePages];
+}
+
+/** Returns NO if the renderer's text cannot be held by the atlas at all. */
+static BOOL runKeysForRenderer(CKTextKitRenderer *renderer, CGSize boundsSize, CGFloat scale,
+                               StyleKey *styleKey, RunKey *runKey)
+{
+  if (!renderer || !rendererIsSingleGlyphRun(renderer, boundsSize)) {
+    return NO;
+  }
+  NSAttributedString *attributedString = renderer.attributes.attributedString;
+  NSDictionary *stringAttributes = [attributedString attributesAtIndex:0 effectiveRange:NULL];
+  *styleKey = {stringAttributes[NSFontAttributeName], stringAttributes[NSForegroundColorAttributeName], scale};
+  *runKey = {attributedString.string, stringAttributes[NSParagraphStyleAttributeName], renderer.drawnRect.size};
+  return YES;
+}
+
+- (BOOL)canHoldRenderer:(CKTextKitRenderer *)renderer boundsSize:(CGSize)boundsSize
+{
+  return renderer && rendererIsSingleGlyphRun(renderer, boundsSize);
+}
+
+- (CKTextComponentGlyphRun *)existingGlyphRunForRenderer:(CKTextKitRenderer *)renderer
+                                              boundsSize:(CGSize)boundsSize
+                                                   scale:(CGFloat)scale
+{
+  StyleKey styleKey;
+  RunKey runKey;
+  if (!runKeysForRenderer(renderer, boundsSize, scale, &styleKey, &runKey)) {
+    return nil;
+  }
+  return [self _existingGlyphRunForStyleKey:styleKey runKey:runKey];
+}
+
+- (CKTextComponentGlyphRun *)glyphRunForRenderer:(CKTextKitRenderer *)renderer
+                                      boundsSize:(CGSize)boundsSize
+                                           scale:(CGFloat)scale
+{
+  StyleKey styleKey;
+  RunKey runKey;
+  if (!runKeysForRenderer(renderer, boundsSize, scale, &styleKey, &runKey)) {
+    return nil;
+  }
+  const NSUInteger width = (NSUInteger)ceil(runKey.size.width * scale);
+  const NSUInteger height = (NSUInteger)ceil(runKey.size.height * scale);
+  if (width > _pagePixelSize || height > _pagePixelSize) {
+    return nil;
+  }
+
+  if (CKTextComponentGlyphRun *glyphRun = [self _existingGlyphRunForStyleKey:styleKey runKey:runKey]) {
+    return glyphRun;
+  }
+
+  // Rasterizing is the slow part, so it happens outside the lock the main thread takes to look runs up.
+  id image = newRunImage(renderer, width, height, scale);
+  if (!image) {
+    return nil;
+  }
+
+  std::lock_guard<std::mutex> l(_mutex);
+  auto &runs = _runsByStyle[styleKey];
+  const auto it = runs.find(runKey);
+  if (it != runs.end()) {
+    // Another thread added the same run while this one was rasterizing it.
+    _hitCount++;
+    return [self _glyphRunForRun:it->second];
+  }
+
+  _missCount++;
+  Run run;
+  if (![self _allocateRegionForRun:&run width:width height:height scale:scale]) {
+    return nil;
+  }
+  run.image = image;
+  // Copy the run's pixels into the open page, so they are part of the page image once it is sealed.
+  Page &page = _pages[run.pageIndex];
+  const CGRect pointRect = {
+    {run.pixelRect.origin.x / scale, run.pixelRect.origin.y / scale},
+    {width / scale, height / scale}
+  };
+  CGContextSaveGState(page.context);
+  // The page's transform flips to UIKit coordinates, so flip again around the run to draw the image upright.
+  CGContextTranslateCTM(page.context, 0, CGRectGetMaxY(pointRect) + CGRectGetMinY(pointRect));
+  CGContextScaleCTM(page.context, 1, -1);
+  CGContextDrawImage(page.context, pointRect, (__bridge CGImageRef)run.image);
+  CGContextRestoreGState(page.context);
+
+  runs.insert({runKey, run});
+  _runCount++;
+  _openRunBytes += width * height * 4;
+  return [self _glyphRunForRun:run];
+}
+
+- (CKTextComponentGlyphAtlasStatistics)statistics
+{
+  std::lock_guard<std::mutex> l(_mutex);
+  return {
+    .runCount = _runCount,
+    .pageCount = _pages.size(),
+    .retainedBytes = _pages.size() * _pagePixelSize * _pagePixelSize * 4 + _openRunBytes,
+    .hitCount = _hitCount,
+    .missCount = _missCount,
+  };
+}
+
+- (void)removeAllRuns
+{
+  std::lock_guard<std::mutex> l(_mutex);
+  _runsByStyle.clear();
+  [self _releasePages];
+  _runCount = 0;
+  _openRunBytes = 0;
+}
+
+#pragma mark - Runs
+
+- (CKTextComponentGlyphRun *)_existingGlyphRunForStyleKey:(const StyleKey &)styleKey runKey:(const RunKey &)runKey
+{
+  std::lock_guard<std::mutex> l(_mutex);
+  const auto runs = _runsByStyle.find(styleKey);
+  if (runs == _runsByStyle.end()) {
+    return nil;
+  }
+  const auto it = runs->second.find(runKey);
+  if (it == runs->second.end()) {
+    return nil;
+  }
+  _hitCount++;
+  return [self _glyphRunForRun:it->second];
+}
+
+#pragma mark - Pages
+
+- (BOOL)_allocateRegionForRun:(Run *)run width:(NSUInteger)width height:(NSUInteger)height scale:(CGFloat)scale
+{
+  CGPoint origin;
+  for (size_t i = 0; i < _pages.size(); i++) {
+    Page &page = _pages[i];
+    if (page.scale != scale || page.context == NULL) {
+      continue;
+    }
+    if (allocateRegionInPage(page, _pagePixelSize, width, height, &origin)) {
+      *run = {i, {origin, {(CGFloat)width, (CGFloat)height}}, nil};
+      return YES;
+    }
+    if (_pages.size() >= _maximumPageCount) {
+      // Keep filling the open page with runs that still fit rather than sealing it with nothing to replace it.
+      return NO;
+    }
+    [self _sealPageAtIndex:i];
+  }
+  if (_pages.size() >= _maximumPageCount) {
+    return NO;
+  }
+  CGContextRef context = newBitmapContext(_pagePixelSize, _pagePixelSize, scale);
+  if (!context) {
+    return NO;
+  }
+  _pages.push_back({scale, context, nil, {}, 0});
+  // Runs larger than a page are turned away before getting here, so an empty page always has room.
+  allocateRegionInPage(_pages.back(), _pagePixelSize, width, height, &origin);
+  *run = {_pages.size() - 1, {origin, {(CGFloat)width, (CGFloat)height}}, nil};
+  return YES;
+}
+
+/** Takes the page's image and lets its runs share it instead of holding images of their own. */
+- (void)_sealPageAtIndex:(size_t)pageIndex
+{
+  Page &page = _pages[pageIndex];
+  page.image = CFBridgingRelease(CGBitmapContextCreateImage(page.context));
+  // With the context gone the image is the only owner of the pixels, so it never copies them.
+  CGContextRelease(page.context);
+  page.context = NULL;
+  for (auto &style : _runsByStyle) {
+    for (auto &entry : style.second) {
+      Run &run = entry.second;
+      if (run.pageIndex == pageIndex && run.image) {
+        CGImageRef imageRef = (__bridge CGImageRef)run.image;
+        _openRunBytes -= CGImageGetWidth(imageRef) * CGImageGetHeight(imageRef) * 4;
+        run.image = nil;
+      }
+    }
+  }
+}
+
+- (CKTextComponentGlyphRun *)_glyphRunForRun:(const Run &)run
+{
+  if (run.image) {
+    return [[CKTextComponentGlyphRun alloc] initWithImage:run.image contentsRect:{{0, 0}, {1, 1}}];
+  }
+  const Page &page = _pages[run.pageIndex];
+  const CGFloat pagePixelSize = _pagePixelSize;
+  return [[CKTextComponentGlyphRun alloc] initWithImage:page.image
+                                           contentsRect:{
+                                             {run.pixelRect.origin.x / pagePixelSize, run.pixelRect.origin.y / pagePixelSize},
+                                             {run.pixelRect.size.width / pagePixelSize, run.pixelRect.size.height / pagePixelSize}
+                                           }];
+}
+
+- (void)_releasePages
+{
+  for (Page &page : _pages) {
+    CGContextRelease(page.context);
+  }
+  _pages.clear();
+}
+
+@end
@@ -10,9 +10,22 @@
 
 #import <ComponentKit/CKAsyncLayer.h>
 
+@class CKTextComponentGlyphAtlas;
 @class CKTextComponentLayerHighlighter;
+@class CKTextComponentRasterizationBudget;
 @class CKTextKitRenderer;
 
+/** How often async display of text found its bitmap in the raster contents cache. */
+struct CKTextComponentRasterStatistics {
+  NSUInteger displayCount;
+  NSUInteger hitCount;
+  /** Hits on a bitmap first drawn for bounds of a different size, which would have been drawn again if rasters were keyed by bounds. */
+  NSUInteger sharedHitCount;
+
+  /** The fraction of displays that were served by a bitmap shared with differently sized layers. */
+  CGFloat dedupRatio() const;
+};
+
 /**
  An implementation detail of the CKTextComponentView.  You should rarely, if ever have to deal directly with this class.
  */
@@ -20,6 +33,24 @@
 
 @property (nonatomic, strong) CKTextKitRenderer *renderer;
 
+/** When set, text that forms a single short glyph run is shown from this atlas instead of being drawn by the layer. */
+@property (nonatomic, strong) CKTextComponentGlyphAtlas *glyphAtlas;
+
 @property (nonatomic, strong, readonly) CKTextComponentLayerHighlighter *highlighter;
 
+/** Counts async displays since launch or the last reset, across all text layers. */
++ (CKTextComponentRasterStatistics)rasterStatistics;
++ (void)resetRasterStatistics;
+
+/**
+ Draws the renderer into the raster contents cache exactly as an async display pass of a layer with the renderer, the
+ background color and the default contents scale would, so that such a layer finds the bitmap instead of drawing it.
+ Safe to call from any thread.
+
+ @return NO if the bitmap was already cached or would not fit in the budget.
+ */
++ (BOOL)rasterizeRenderer:(CKTextKitRenderer *)renderer
+          backgroundColor:(UIColor *)backgroundColor
+                   budget:(CKTextComponentRasterizationBudget *)budget;
+
 @end
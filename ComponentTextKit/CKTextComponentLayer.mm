@@ -10,24 +10,157 @@
 
 #import "CKTextComponentLayer.h"
 
+#import <atomic>
+#import <memory>
+
 #import <ComponentKit/CKInternalHelpers.h>
 #import <ComponentKit/CKTextKitAttributes.h>
 #import <ComponentKit/CKTextKitRenderer.h>
 #import <ComponentKit/CKTextKitRendererCache.h>
 #import <ComponentKit/CKAssert.h>
+#import <ComponentKit/CKAsyncDisplayScheduler.h>
+#import <ComponentKit/CKAsyncLayerInternal.h>
 
+#import "CKTextComponentGlyphAtlas.h"
 #import "CKTextComponentLayerHighlighter.h"
+#import "CKTextComponentRasterizationBudget.h"
+
+/**
+ Identifies a bitmap by what is actually drawn into it. Text that is not truncated is drawn into a bitmap that only
+ covers its drawn rect, so layers whose bounds differ but whose text lays out identically share it. Anything else is
+ drawn into a bitmap the size of the bounds, as before.
+ */
+struct CKTextComponentRasterKey {
+  CKTextKitAttributes attributes;
+  CGRect rect;
+  CGFloat scale;
+  bool coversDrawnRectOnly;
+  size_t hash;
 
-static CK::TextKit::Renderer::Cache *rasterContentsCache()
+  CKTextComponentRasterKey(const CKTextKitAttributes &a, size_t attributesHash, CGRect r, CGFloat s, bool drawnRectOnly)
+  : attributes(a), rect(r), scale(s), coversDrawnRectOnly(drawnRectOnly)
+  {
+    const size_t subhashes[] = {
+      std::hash<CGFloat>()(rect.origin.x),
+      std::hash<CGFloat>()(rect.origin.y),
+      std::hash<CGFloat>()(rect.size.width),
+      std::hash<CGFloat>()(rect.size.height),
+      std::hash<CGFloat>()(scale),
+      coversDrawnRectOnly,
+    };
+    hash = attributesHash;
+    for (size_t subhash : subhashes) {
+      hash ^= subhash + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+  }
+
+  bool operator==(const CKTextComponentRasterKey &other) const
+  {
+    return hash == other.hash
+    && coversDrawnRectOnly == other.coversDrawnRectOnly
+    && CGRectEqualToRect(rect, other.rect)
+    && scale == other.scale
+    && attributes == other.attributes;
+  }
+};
+
+struct CKTextComponentRasterKeyHasher {
+  size_t operator()(const CKTextComponentRasterKey &k) const
+  {
+    return k.hash;
+  }
+};
+
+typedef CK::TextKit::Renderer::CacheT<CKTextComponentRasterKey, CKTextComponentRasterKeyHasher> CKTextComponentRasterCache;
+
+static CKTextComponentRasterCache *rasterContentsCache()
 {
   // 6MB raster contents cache that evicts 20% of the least recently used bitmaps it contains when it hits 6MB
-  static CK::TextKit::Renderer::Cache *__rasterContentsCache (new CK::TextKit::Renderer::Cache("CKTextComponentRasterContentsCache", 6 * 1024 * 1025, 0.2));
+  static CKTextComponentRasterCache *__rasterContentsCache (new CKTextComponentRasterCache("CKTextComponentRasterContentsCache", 6 * 1024 * 1025, 0.2));
   return __rasterContentsCache;
 }
 
+/** A cached bitmap along with the size of the bounds it was first drawn for, to tell shared bitmaps apart. */
+@interface CKTextComponentRasterContents : NSObject
+{
+@public
+  id _image;
+  CGSize _boundsSize;
+}
+@end
+
+@implementation CKTextComponentRasterContents
+@end
+
+static std::atomic<NSUInteger> __displayCount(0);
+static std::atomic<NSUInteger> __hitCount(0);
+static std::atomic<NSUInteger> __sharedHitCount(0);
+
+/**
+ The part of a shared bitmap the renderer may draw into. The drawn rect does not bound glyph ink, so italic and
+ overhanging glyphs get a margin of a quarter of a line; drawing is clipped to the margin so the row and column of
+ padding past it are always background.
+ */
+static CGRect sharedInkRectForRenderer(CKTextKitRenderer *renderer)
+{
+  const CGRect drawnRect = renderer.drawnRect;
+  const CGFloat inkMargin = CKCeilPixelValue(drawnRect.size.height / MAX(renderer.lineCount, (NSUInteger)1) / 4);
+  return {
+    CGPointZero,
+    {CKCeilPixelValue(CGRectGetMaxX(drawnRect) + inkMargin), CKCeilPixelValue(CGRectGetMaxY(drawnRect) + inkMargin)},
+  };
+}
+
+/** Decides which bitmap text is drawn into for bounds of the given size, and what size that bitmap is. */
+static CKTextComponentRasterKey rasterKeyForRenderer(CKTextKitRenderer *renderer, CGSize boundsSize, CGSize *bitmapSize)
+{
+  const CGFloat scale = CKScreenScale();
+  const CGRect inkRect = sharedInkRectForRenderer(renderer);
+  // One extra row and column of background pixels is stretched over the rest of the bounds using contentsCenter.
+  const CGSize paddedSize = {inkRect.size.width + 1 / scale, inkRect.size.height + 1 / scale};
+  if (!renderer.isTruncated
+      && paddedSize.width <= boundsSize.width
+      && paddedSize.height <= boundsSize.height) {
+    *bitmapSize = paddedSize;
+    return {renderer.attributes, renderer.attributesHash, renderer.drawnRect, scale, true};
+  }
+  *bitmapSize = boundsSize;
+  return {renderer.attributes, renderer.attributesHash, {CGPointZero, boundsSize}, scale, false};
+}
+
+/** The raster key of one display pass, so the hooks of a pass agree on it without each building it again. */
+struct CKTextComponentRasterPass {
+  CKTextKitRenderer *renderer;
+  CGSize boundsSize;
+  CGSize bitmapSize;
+  CKTextComponentRasterKey key;
+
+  CKTextComponentRasterPass(CKTextKitRenderer *r, CGSize b)
+  : renderer(r), boundsSize(b), key(rasterKeyForRenderer(r, b, &bitmapSize)) {}
+};
+
+/** Stretches only the padding of a bitmap that covers less than the bounds, so the text itself is never scaled. */
+static CGRect contentsCenterForContents(id contents, CGSize boundsSize, CGFloat scale)
+{
+  CGImageRef imageRef = (__bridge CGImageRef)contents;
+  const CGFloat pixelWidth = imageRef ? CGImageGetWidth(imageRef) : 0;
+  const CGFloat pixelHeight = imageRef ? CGImageGetHeight(imageRef) : 0;
+  if (pixelWidth == 0 || pixelHeight == 0
+      || (pixelWidth >= round(boundsSize.width * scale) && pixelHeight >= round(boundsSize.height * scale))) {
+    return {{0, 0}, {1, 1}};
+  }
+  return {{(pixelWidth - 1) / pixelWidth, (pixelHeight - 1) / pixelHeight}, {1 / pixelWidth, 1 / pixelHeight}};
+}
+
+CGFloat CKTextComponentRasterStatistics::dedupRatio() const
+{
+  return displayCount ? (CGFloat)sharedHitCount / (CGFloat)displayCount : 0;
+}
+
 @implementation CKTextComponentLayer
 {
   CKTextComponentLayerHighlighter *_highlighter;
+  std::unique_ptr<CKTextComponentRasterPass> _rasterPass;
 }
 
 + (id)defaultValueForKey:(NSString *)key
@@ -83,28 +216,156 @@ static CK::TextKit::Renderer::Cache *rasterContentsCache()
   return _renderer;
 }
 
++ (BOOL)rasterizeRenderer:(CKTextKitRenderer *)renderer
+          backgroundColor:(UIColor *)backgroundColor
+                   budget:(CKTextComponentRasterizationBudget *)budget
+{
+  if (CGRectIsEmpty({CGPointZero, renderer.constrainedSize})) {
+    return NO;
+  }
+  CGSize bitmapSize;
+  const CKTextComponentRasterKey key = rasterKeyForRenderer(renderer, renderer.constrainedSize, &bitmapSize);
+  if (rasterContentsCache()->objectForKey(key)) {
+    return NO;
+  }
+
+  const CGRect bounds = {CGPointZero, bitmapSize};
+  const CGFloat scale = CKScreenScale();
+  const NSUInteger estimatedBytes = (NSUInteger)(ceil(bounds.size.width * scale) * 4 * ceil(bounds.size.height * scale));
+  if (![budget consumeBytes:estimatedBytes]) {
+    return NO;
+  }
+
+  // Mirror the state CKTextComponentView leaves its layer in: white and opaque unless given a translucent background.
+  UIColor *color = backgroundColor ?: [UIColor whiteColor];
+  const BOOL opaque = CGColorGetAlpha(color.CGColor) == 1.0;
+  ck_async_transaction_operation_block_t displayBlock =
+  [self asyncDisplayBlockWithBounds:bounds
+                      contentsScale:scale
+                             opaque:opaque
+                    backgroundColor:color.CGColor
+                    displaySentinel:NULL
+       expectedDisplaySentinelValue:0
+                    drawingDelegate:(id<CKAsyncLayerDrawingDelegate>)self
+                     drawParameters:renderer];
+  id contents = displayBlock();
+  if (!contents) {
+    return NO;
+  }
+  CKTextComponentRasterContents *rasterContents = [CKTextComponentRasterContents new];
+  rasterContents->_image = contents;
+  rasterContents->_boundsSize = renderer.constrainedSize;
+  CGImageRef imageRef = (__bridge CGImageRef)contents;
+  rasterContentsCache()->cacheObject(key, rasterContents, CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef));
+  return YES;
+}
+
++ (CKTextComponentRasterStatistics)rasterStatistics
+{
+  return {
+    .displayCount = __displayCount.load(),
+    .hitCount = __hitCount.load(),
+    .sharedHitCount = __sharedHitCount.load(),
+  };
+}
+
++ (void)resetRasterStatistics
+{
+  __displayCount = 0;
+  __hitCount = 0;
+  __sharedHitCount = 0;
+}
+
+- (id)contentsWithoutDrawingWithDrawParameters:(id<NSObject>)drawParameters
+{
+  CKTextComponentGlyphAtlas *glyphAtlas = _glyphAtlas;
+  CKTextKitRenderer *renderer = _renderer;
+  const CGSize boundsSize = self.bounds.size;
+  const CGFloat scale = self.contentsScale;
+  // Only look the run up here; rasterizing a miss on the main thread would also hold up every other atlas user.
+  CKTextComponentGlyphRun *glyphRun = [glyphAtlas existingGlyphRunForRenderer:renderer boundsSize:boundsSize scale:scale];
+  if (!glyphRun && [glyphAtlas canHoldRenderer:renderer boundsSize:boundsSize]) {
+    // This layer draws the regular way; filling the atlas in the background lets the next layer with the text share it.
+    [[[self class] displayScheduler] scheduleBlock:^{
+      [glyphAtlas glyphRunForRenderer:renderer boundsSize:boundsSize scale:scale];
+    } priority:CKAsyncLayerDisplayPriorityPrefetch];
+  }
+  if (glyphRun) {
+    // Show the run's region of the image at its natural size in the top left, where the renderer would have drawn it.
+    self.contentsRect = glyphRun.contentsRect;
+    self.contentsGravity = kCAGravityTopLeft;
+    self.contentsCenter = {{0, 0}, {1, 1}};
+    return glyphRun.image;
+  }
+  self.contentsRect = {{0, 0}, {1, 1}};
+  self.contentsGravity = kCAGravityResize;
+  return nil;
+}
+
+- (const CKTextComponentRasterPass &)rasterPassForRenderer:(CKTextKitRenderer *)renderer
+{
+  const CGSize boundsSize = self.bounds.size;
+  if (!_rasterPass || _rasterPass->renderer != renderer || !CGSizeEqualToSize(_rasterPass->boundsSize, boundsSize)) {
+    _rasterPass.reset(new CKTextComponentRasterPass(renderer, boundsSize));
+  }
+  return *_rasterPass;
+}
+
+- (CGSize)asyncDisplaySizeWithDrawParameters:(id<NSObject>)drawParameters
+{
+  return [self rasterPassForRenderer:(CKTextKitRenderer *)drawParameters].bitmapSize;
+}
+
 - (id)willDisplayAsynchronouslyWithDrawParameters:(id<NSObject>)drawParameters
 {
-  return rasterContentsCache()->objectForKey({_renderer.attributes, _renderer.constrainedSize});
+  __displayCount++;
+  const CGSize boundsSize = self.bounds.size;
+  CKTextComponentRasterContents *rasterContents =
+  rasterContentsCache()->objectForKey([self rasterPassForRenderer:(CKTextKitRenderer *)drawParameters].key);
+  if (!rasterContents) {
+    return nil;
+  }
+  __hitCount++;
+  if (!CGSizeEqualToSize(rasterContents->_boundsSize, boundsSize)) {
+    __sharedHitCount++;
+  }
+  self.contentsCenter = contentsCenterForContents(rasterContents->_image, boundsSize, self.contentsScale);
+  return rasterContents->_image;
 }
 
 - (void)didDisplayAsynchronously:(id)newContents withDrawParameters:(id<NSObject>)drawParameters
 {
   if (newContents) {
+    const CGSize boundsSize = self.bounds.size;
+    CKTextComponentRasterContents *rasterContents = [CKTextComponentRasterContents new];
+    rasterContents->_image = newContents;
+    rasterContents->_boundsSize = boundsSize;
     CGImageRef imageRef = (__bridge CGImageRef)newContents;
     NSUInteger bytes = CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef);
-    rasterContentsCache()->cacheObject({_renderer.attributes, _renderer.constrainedSize}, newContents, bytes);
+    const CKTextComponentRasterKey &key = [self rasterPassForRenderer:(CKTextKitRenderer *)drawParameters].key;
+    rasterContentsCache()->cacheObject(key, rasterContents, bytes);
+    self.contentsCenter = contentsCenterForContents(newContents, boundsSize, self.contentsScale);
   }
 }
 
 + (void)drawInContext:(CGContextRef)context parameters:(CKTextKitRenderer *)renderer
 {
   CGRect boundsRect = CGContextGetClipBoundingBox(context);
+  const CGFloat scale = CKScreenScale();
+  CGSize bitmapSize;
+  if (rasterKeyForRenderer(renderer, boundsRect.size, &bitmapSize).coversDrawnRectOnly
+      && round(bitmapSize.width * scale) == round(boundsRect.size.width * scale)
+      && round(bitmapSize.height * scale) == round(boundsRect.size.height * scale)) {
+    // A shared bitmap: keep ink out of the padding that is stretched over the rest of the bounds.
+    CGContextClipToRect(context, sharedInkRectForRenderer(renderer));
+  }
   [renderer drawInContext:context bounds:boundsRect];
 }
 
 - (void)drawInContext:(CGContextRef)ctx
 {
+  // Synchronous drawing always fills the bounds.
+  self.contentsCenter = {{0, 0}, {1, 1}};
   // When we're drawing synchronously we need to manually fill the bg color because CKAsyncLayer doesn't.
   if (self.opaque && self.backgroundColor != NULL) {
     CGRect boundsRect = CGContextGetClipBoundingBox(ctx);
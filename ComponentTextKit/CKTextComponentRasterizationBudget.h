@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <ComponentKit/CKMacros.h>
+
+/**
+ Lets text components rasterize their text while they are laid out, off the main thread, so the bitmap is already in the
+ raster contents cache when they are mounted instead of being drawn after the cell appears. Only layouts with an exact
+ size range are rasterized, since a parent may try other sizes before settling on the one the text is mounted at.
+
+ Rasterizing costs memory and preparation time, so it is bounded by a number of bytes shared by every text component that
+ sees the same budget. Create one budget per batch of components and put it in a component context while the components
+ of that batch are created:
+
+ @example CKComponentContext<CKTextComponentRasterizationBudget> budgetContext(budget);
+
+ Text components created without a budget in context are only rasterized after mount, as before. The budget is
+ threadsafe, so components of a batch may be laid out concurrently.
+ */
+@interface CKTextComponentRasterizationBudget : NSObject
+
+- (instancetype)initWithByteLimit:(NSUInteger)byteLimit;
+
+- (instancetype)init CK_NOT_DESIGNATED_INITIALIZER_ATTRIBUTE;
+
+@property (nonatomic, assign, readonly) NSUInteger byteLimit;
+
+/** The number of bytes of bitmaps that have been rasterized against this budget so far. */
+@property (nonatomic, assign, readonly) NSUInteger consumedBytes;
+
+/** Reserves bytes for a bitmap. Returns NO, reserving nothing, if that would exceed the byte limit. */
+- (BOOL)consumeBytes:(NSUInteger)bytes;
+
+@end
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import "CKTextComponentRasterizationBudget.h"
+
+#import <atomic>
+
+@implementation CKTextComponentRasterizationBudget
+{
+  std::atomic<NSUInteger> _consumedBytes;
+}
+
+- (instancetype)initWithByteLimit:(NSUInteger)byteLimit
+{
+  if (self = [super init]) {
+    _byteLimit = byteLimit;
+    _consumedBytes = 0;
+  }
+  return self;
+}
+
+- (instancetype)init
+{
+  CK_NOT_DESIGNATED_INITIALIZER();
+}
+
+- (NSUInteger)consumedBytes
+{
+  return _consumedBytes.load();
+}
+
+- (BOOL)consumeBytes:(NSUInteger)bytes
+{
+  NSUInteger consumed = _consumedBytes.load();
+  do {
+    if (bytes > _byteLimit - consumed) {
+      return NO;
+    }
+  } while (!_consumedBytes.compare_exchange_weak(consumed, consumed + bytes));
+  return YES;
+}
+
+@end
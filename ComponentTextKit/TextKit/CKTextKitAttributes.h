@@ -111,6 +111,13 @@ struct CKTextKitAttributes {
     && _objectsEqual(truncationAttributedString, other.truncationAttributedString);
   }
 
+  /**
+   A hash of the full contents of the attributes, including every character of the strings and all of their attribute
+   runs. Unlike -[NSAttributedString hash], which only looks at a few characters of long strings, this rarely collides
+   for strings sharing a prefix. It walks every character, so it is not computed by the attributes themselves, which
+   may still be modified: compute it once where the attributes can no longer change (CKTextComponent and
+   CKTextKitRenderer hold it next to their copy) and pass it to the cache keys, which compare it first.
+   */
   size_t hash() const;
 };
 
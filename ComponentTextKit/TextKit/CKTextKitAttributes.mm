@@ -10,26 +10,73 @@
 
 #import <ComponentKit/CKTextKitAttributes.h>
 
-#import <ComponentKit/CKInternalHelpers.h>
-
 #include <functional>
 
 NSString *const CKTextKitTruncationAttributeName = @"ck_truncation";
 NSString *const CKTextKitEntityAttributeName = @"ck_entity";
 
+static const uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+static const uint64_t kFNVPrime = 1099511628211ULL;
+
+static inline uint64_t hashCombine(uint64_t hash, uint64_t value)
+{
+  hash = (hash ^ value) * kFNVPrime;
+  return hash ^ (hash >> 32);
+}
+
+static uint64_t hashCharacters(NSString *string, uint64_t hash)
+{
+  const NSUInteger length = string.length;
+  const UniChar *characters = CFStringGetCharactersPtr((__bridge CFStringRef)string);
+  static const NSUInteger kBufferLength = 256;
+  UniChar buffer[kBufferLength];
+  for (NSUInteger location = 0; location < length; location += kBufferLength) {
+    const NSRange range = {location, MIN(kBufferLength, length - location)};
+    const UniChar *chunk = characters ? characters + location : buffer;
+    if (!characters) {
+      [string getCharacters:buffer range:range];
+    }
+    for (NSUInteger i = 0; i < range.length; i++) {
+      hash = (hash ^ chunk[i]) * kFNVPrime;
+    }
+  }
+  return hash;
+}
+
+/** Hashes every character and every attribute run, unlike -[NSAttributedString hash]. */
+static uint64_t attributedStringHash(NSAttributedString *attributedString)
+{
+  if (attributedString == nil) {
+    return 0;
+  }
+  __block uint64_t hash = hashCharacters(attributedString.string, kFNVOffsetBasis);
+  [attributedString enumerateAttributesInRange:{0, attributedString.length}
+                                       options:0
+                                    usingBlock:^(NSDictionary *attributes, NSRange range, BOOL *stop) {
+                                      // Dictionary enumeration order is unspecified, so the entries of a run are
+                                      // combined in an order-independent way.
+                                      __block uint64_t runHash = 0;
+                                      [attributes enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *innerStop) {
+                                        runHash += hashCombine(hashCombine(kFNVOffsetBasis, [key hash]), [value hash]);
+                                      }];
+                                      hash = hashCombine(hashCombine(hashCombine(hash, range.location), range.length), runHash);
+                                    }];
+  return hash;
+}
+
 size_t CKTextKitAttributes::hash() const
 {
-  NSUInteger subhashes[] = {
-    [attributedString hash],
-    [truncationAttributedString hash],
-    [avoidTailTruncationSet hash],
-    std::hash<NSInteger>()(lineBreakMode),
-    std::hash<NSInteger>()(maximumNumberOfLines),
-    std::hash<CGFloat>()(shadowOffset.width),
-    std::hash<CGFloat>()(shadowOffset.height),
-    [shadowColor hash],
-    std::hash<CGFloat>()(shadowOpacity),
-    std::hash<CGFloat>()(shadowRadius),
-  };
-  return CKIntegerArrayHash(subhashes, sizeof(subhashes) / sizeof(subhashes[0]));
+  // Every field is folded into a 64-bit state; CKIntegerArrayHash only keeps the last couple of values it is given.
+  uint64_t hash = kFNVOffsetBasis;
+  hash = hashCombine(hash, attributedStringHash(attributedString));
+  hash = hashCombine(hash, attributedStringHash(truncationAttributedString));
+  hash = hashCombine(hash, [avoidTailTruncationSet hash]);
+  hash = hashCombine(hash, lineBreakMode);
+  hash = hashCombine(hash, maximumNumberOfLines);
+  hash = hashCombine(hash, std::hash<CGFloat>()(shadowOffset.width));
+  hash = hashCombine(hash, std::hash<CGFloat>()(shadowOffset.height));
+  hash = hashCombine(hash, [shadowColor hash]);
+  hash = hashCombine(hash, std::hash<CGFloat>()(shadowOpacity));
+  hash = hashCombine(hash, std::hash<CGFloat>()(shadowRadius));
+  return (size_t)(sizeof(size_t) < sizeof(uint64_t) ? hash ^ (hash >> 32) : hash);
 }
@@ -21,7 +21,10 @@
 /**
  Initializes a context and its associated TextKit components.
 
- Initialization of TextKit components is a globally locking operation so be careful of bottlenecks with this class.
+ The TextKit components of deallocated contexts are kept in a small shared pool and reset with the new string and size,
+ so most contexts allocate nothing while others are being released, whichever thread releases them. Creating new TextKit
+ components, and taking them from or returning them to the pool, is a globally locking operation so be careful of
+ bottlenecks with this class.
  */
 - (instancetype)initWithAttributedString:(NSAttributedString *)attributedString
                            lineBreakMode:(NSLineBreakMode)lineBreakMode
@@ -42,3 +45,18 @@
                                                           NSTextContainer *textContainer))block;
 
 @end
+
+/** Counts of how contexts got their TextKit components, to measure pooling and contention on the global lock. */
+struct CKTextKitContextStatistics {
+  /** Contexts that had to create new TextKit components under the global lock. */
+  NSUInteger createdComponentCount;
+  /** Contexts that reused the components of a deallocated context from the shared pool. */
+  NSUInteger reusedComponentCount;
+  /** Contexts that found the global lock held by another thread when taking or creating components. */
+  NSUInteger contendedCreationCount;
+  /** Total time spent waiting for the global lock. */
+  NSTimeInterval creationLockWaitTime;
+};
+
+struct CKTextKitContextStatistics CKTextKitContextGetStatistics(void);
+void CKTextKitContextResetStatistics(void);
@@ -8,10 +8,88 @@
  *
  */
 
+#import <atomic>
 #import <mutex>
+#import <vector>
+
+#import <QuartzCore/QuartzCore.h>
 
 #import <ComponentKit/CKTextKitContext.h>
 
+/** One set of TextKit components, wired together with the configuration every context uses. */
+struct CKTextKitComponents {
+  NSTextStorage *textStorage;
+  NSLayoutManager *layoutManager;
+  NSTextContainer *textContainer;
+};
+
+/**
+ Bounds the memory held by idle components. Contexts are usually released on a different thread than the one that
+ created them (by the renderer cache evicting them, or by the main thread unmounting views), so the pool is shared. It
+ is sized to take in most of the renderers a full renderer cache evicts at once.
+ */
+static const size_t kMaximumPooledComponents = 32;
+
+static std::atomic<NSUInteger> __createdComponentCount(0);
+static std::atomic<NSUInteger> __reusedComponentCount(0);
+static std::atomic<NSUInteger> __contendedCreationCount(0);
+static std::atomic<uint64_t> __creationLockWaitMicroseconds(0);
+
+// Concurrently initialising TextKit components crashes (rdar://18448377) so we use a global lock. Taking components
+// from the pool and returning them only moves a few pointers, so the same lock guards the pool.
+static std::mutex __componentsMutex;
+static std::vector<CKTextKitComponents> *componentPool()
+{
+  static std::vector<CKTextKitComponents> *__componentPool = new std::vector<CKTextKitComponents>();
+  return __componentPool;
+}
+
+static CKTextKitComponents createComponents()
+{
+  __createdComponentCount++;
+  // Create the TextKit component stack with our default configuration.
+  CKTextKitComponents components {
+    [[NSTextStorage alloc] init],
+    [[NSLayoutManager alloc] init],
+    [[NSTextContainer alloc] initWithSize:CGSizeZero],
+  };
+  components.layoutManager.usesFontLeading = NO;
+  [components.textStorage addLayoutManager:components.layoutManager];
+  // We want the text laid out up to the very edges of the container.
+  components.textContainer.lineFragmentPadding = 0;
+  [components.layoutManager addTextContainer:components.textContainer];
+  return components;
+}
+
+/** Pooled components still hold the string of their previous context; the caller replaces it. */
+static CKTextKitComponents takeComponents()
+{
+  std::unique_lock<std::mutex> l(__componentsMutex, std::try_to_lock);
+  if (!l.owns_lock()) {
+    const CFTimeInterval start = CACurrentMediaTime();
+    l.lock();
+    __contendedCreationCount++;
+    __creationLockWaitMicroseconds += (uint64_t)((CACurrentMediaTime() - start) * 1e6);
+  }
+  std::vector<CKTextKitComponents> *pool = componentPool();
+  if (pool->empty()) {
+    return createComponents();
+  }
+  const CKTextKitComponents components = pool->back();
+  pool->pop_back();
+  __reusedComponentCount++;
+  return components;
+}
+
+static void returnComponents(const CKTextKitComponents &components)
+{
+  std::lock_guard<std::mutex> l(__componentsMutex);
+  std::vector<CKTextKitComponents> *pool = componentPool();
+  if (pool->size() < kMaximumPooledComponents) {
+    pool->push_back(components);
+  }
+}
+
 @implementation CKTextKitContext
 {
   // All TextKit operations (even non-mutative ones) must be executed serially.
@@ -28,24 +106,30 @@
                          constrainedSize:(CGSize)constrainedSize
 {
   if (self = [super init]) {
-    // Concurrently initialising TextKit components crashes (rdar://18448377) so we use a global lock.
-    static std::mutex __static_mutex;
-    std::lock_guard<std::mutex> l(__static_mutex);
-    // Create the TextKit component stack with our default configuration.
-    _textStorage = (attributedString ? [[NSTextStorage alloc] initWithAttributedString:attributedString] : [[NSTextStorage alloc] init]);
-    _layoutManager = [[NSLayoutManager alloc] init];
-    _layoutManager.usesFontLeading = NO;
-    [_textStorage addLayoutManager:_layoutManager];
-    _textContainer = [[NSTextContainer alloc] initWithSize:constrainedSize];
-    // We want the text laid out up to the very edges of the container.
-    _textContainer.lineFragmentPadding = 0;
+    const CKTextKitComponents components = takeComponents();
+    _textStorage = components.textStorage;
+    _layoutManager = components.layoutManager;
+    _textContainer = components.textContainer;
+
+    // Replacing the string of reused components here keeps the layout invalidation it causes on this thread, instead
+    // of on whichever thread released their previous context.
+    if (attributedString) {
+      [_textStorage setAttributedString:attributedString];
+    } else if (_textStorage.length > 0) {
+      [_textStorage deleteCharactersInRange:NSMakeRange(0, _textStorage.length)];
+    }
+    _textContainer.size = constrainedSize;
     _textContainer.lineBreakMode = lineBreakMode;
     _textContainer.maximumNumberOfLines = maximumNumberOfLines;
-    [_layoutManager addTextContainer:_textContainer];
   }
   return self;
 }
 
+- (void)dealloc
+{
+  returnComponents({_textStorage, _layoutManager, _textContainer});
+}
+
 - (void)performBlockWithLockedTextKitComponents:(void (^)(NSLayoutManager *,
                                                           NSTextStorage *,
                                                           NSTextContainer *))block
@@ -55,3 +139,21 @@
 }
 
 @end
+
+CKTextKitContextStatistics CKTextKitContextGetStatistics(void)
+{
+  return {
+    .createdComponentCount = __createdComponentCount.load(),
+    .reusedComponentCount = __reusedComponentCount.load(),
+    .contendedCreationCount = __contendedCreationCount.load(),
+    .creationLockWaitTime = (NSTimeInterval)__creationLockWaitMicroseconds.load() / 1e6,
+  };
+}
+
+void CKTextKitContextResetStatistics(void)
+{
+  __createdComponentCount = 0;
+  __reusedComponentCount = 0;
+  __contendedCreationCount = 0;
+  __creationLockWaitMicroseconds = 0;
+}
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <atomic>
+#import <functional>
+#import <memory>
+#import <vector>
+
+#import <Foundation/Foundation.h>
+
+#import <ComponentKit/CKTextKitRendererCache.h>
+
+@class CKTextKitRenderer;
+
+namespace CK {
+  namespace TextKit {
+    namespace Measurement {
+      /** What a text layout backend reports after laying out attributes at a constrained size. */
+      struct Result {
+        /** The size of the laid out text, in the same coordinate space as the constrained size. */
+        CGSize size;
+        /** Whether any characters were cut off by the constrained size or by the maximum number of lines. */
+        BOOL truncated;
+      };
+
+      /**
+       Lays out attributes at a constrained size. The measurement cache only calls its backend on a miss, so a backend
+       that does not touch TextKit at all can be plugged in to exercise or benchmark the cache without drawing.
+       */
+      typedef std::function<Result(const CKTextKitAttributes &attributes, size_t attributesHash, CGSize constrainedSize)> Backend;
+
+      /** Builds a Result from a renderer that has already been laid out. */
+      Result resultForRenderer(CKTextKitRenderer *renderer);
+
+      struct Key {
+        CKTextKitAttributes attributes;
+
+        /** attributesHash must be a.hash(); see Renderer::Key. */
+        Key(const CKTextKitAttributes &a, size_t attributesHash);
+
+        size_t hash;
+
+        bool operator==(const Key &other) const
+        {
+          return hash == other.hash && attributes == other.attributes;
+        }
+      };
+
+      struct KeyHasher {
+        size_t operator()(const Key &k) const
+        {
+          return k.hash;
+        }
+      };
+
+      /**
+       A laid out size together with the range of constrained sizes that are guaranteed to produce the exact same
+       layout.
+
+       Wrapping is greedy for the line-break modes CKTextKit supports: a line breaks as soon as the next glyph no longer
+       fits in the constrained width. If an untruncated layout at width W has a used width of U, every width in [U, W]
+       breaks the text at the same places, so the size is the same. Any height of at least the laid out height keeps
+       every line visible. A measurement at an unbounded width records the natural single-line width of the text.
+       */
+      struct Record {
+        CGFloat minimumWidth;
+        CGFloat maximumWidth;
+        CGSize size;
+
+        bool contains(CGSize constrainedSize) const
+        {
+          return constrainedSize.width >= minimumWidth
+          && constrainedSize.width <= maximumWidth
+          && constrainedSize.height >= size.height;
+        }
+      };
+
+      struct Statistics {
+        NSUInteger hitCount;
+        NSUInteger missCount;
+
+        CGFloat hitRate() const
+        {
+          const NSUInteger total = hitCount + missCount;
+          return total ? (CGFloat)hitCount / (CGFloat)total : 0;
+        }
+      };
+
+      /**
+       Answers size queries for text without building new TextKit layouts when a query falls within a range that an
+       earlier measurement of the same attributes already covers. Measurements are keyed by attributes alone, so the
+       same entry serves every constrained size the text is asked to fit.
+
+       Only untruncated layouts are recorded: truncation depends on the exact constrained size, so those queries always
+       go to the backend. The cache is threadsafe and is emptied on memory warnings and backgrounding.
+       */
+      class Cache {
+      public:
+        Cache(const std::string &cacheName, NSUInteger maxCost, CGFloat compactionFactor, Backend backend);
+        ~Cache();
+
+        /** attributesHash must be attributes.hash(). */
+        CGSize sizeForAttributes(const CKTextKitAttributes &attributes, size_t attributesHash, CGSize constrainedSize);
+
+        Statistics statistics() const;
+        void resetStatistics();
+
+        void compact(CGFloat compactionFactor);
+        void removeAllObjects();
+
+        /** The largest number of width ranges remembered for one set of attributes. */
+        static const size_t kMaximumRecordsPerKey = 8;
+
+      private:
+        typedef std::shared_ptr<const std::vector<Record>> Records;
+
+        CK::ConcurrentCacheImpl<const Key, Records, KeyHasher> _cache;
+        Backend _backend;
+        ApplicationObserver *_applicationObserver;
+        std::atomic<NSUInteger> _hitCount;
+        std::atomic<NSUInteger> _missCount;
+
+        Cache(const Cache &) = delete;
+        Cache &operator=(const Cache &) = delete;
+      };
+    };
+  };
+};
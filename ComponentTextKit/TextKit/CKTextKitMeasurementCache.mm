@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <ComponentKit/CKTextKitMeasurementCache.h>
+
+#import <ComponentKit/CKTextKitRenderer.h>
+
+namespace CK {
+  namespace TextKit {
+    namespace Measurement {
+      Result resultForRenderer(CKTextKitRenderer *renderer)
+      {
+        return {
+          .size = renderer.size,
+          .truncated = renderer.isTruncated,
+        };
+      }
+
+      Key::Key(const CKTextKitAttributes &a, size_t attributesHash) : attributes(a), hash(attributesHash) {}
+
+      const size_t Cache::kMaximumRecordsPerKey;
+
+      Cache::Cache(const std::string &cacheName, NSUInteger maxCost, CGFloat compactionFactor, Backend backend)
+      : _cache(cacheName, maxCost, compactionFactor), _backend(backend), _hitCount(0), _missCount(0)
+      {
+        _applicationObserver = new ApplicationObserver([this] {
+          compact(0.95);
+        }, [this] {
+          removeAllObjects();
+        });
+      }
+
+      Cache::~Cache()
+      {
+        delete _applicationObserver;
+      }
+
+      CGSize Cache::sizeForAttributes(const CKTextKitAttributes &attributes, size_t attributesHash, CGSize constrainedSize)
+      {
+        const Key key {attributes, attributesHash};
+        const Records records = _cache.find(key, nullptr);
+        if (records) {
+          for (const auto &record : *records) {
+            if (record.contains(constrainedSize)) {
+              _hitCount++;
+              return record.size;
+            }
+          }
+        }
+
+        _missCount++;
+        const Result result = _backend(attributes, attributesHash, constrainedSize);
+        if (result.truncated) {
+          return result.size;
+        }
+
+        // Records are immutable once published so readers never need the lock after the lookup; a concurrent miss on
+        // the same key may overwrite this one, which only costs a future miss.
+        auto updated = std::make_shared<std::vector<Record>>();
+        if (records) {
+          updated->reserve(std::min(records->size() + 1, kMaximumRecordsPerKey));
+          const size_t kept = std::min(records->size(), kMaximumRecordsPerKey - 1);
+          updated->insert(updated->end(), records->end() - kept, records->end());
+        }
+        updated->push_back({
+          .minimumWidth = result.size.width,
+          .maximumWidth = constrainedSize.width,
+          .size = result.size,
+        });
+        _cache.insert(key, updated, 1);
+        return result.size;
+      }
+
+      Statistics Cache::statistics() const
+      {
+        return {_hitCount.load(), _missCount.load()};
+      }
+
+      void Cache::resetStatistics()
+      {
+        _hitCount = 0;
+        _missCount = 0;
+      }
+
+      void Cache::compact(CGFloat compactionFactor)
+      {
+        _cache.compact(compactionFactor);
+      }
+
+      void Cache::removeAllObjects()
+      {
+        _cache.removeAllObjects();
+      }
+    }
+  }
+}
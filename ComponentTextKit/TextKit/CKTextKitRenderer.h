@@ -51,6 +51,9 @@ dvlkferufedgjnhjjfhldjedlunvtdtv
 
 @property (nonatomic, assign, readonly) CKTextKitAttributes attributes;
 
+/** attributes.hash(), computed once since the renderer's attributes never change. */
+@property (nonatomic, assign, readonly) size_t attributesHash;
+
 @property (nonatomic, assign, readonly) CGSize constrainedSize;
 
 #pragma mark - Drawing
@@ -68,6 +71,24 @@ dvlkferufedgjnhjjfhldjedlunvtdtv
  */
 - (CGSize)size;
 
+/*
+ An estimate of the bytes retained by the TextKit objects backing this renderer, based on the length of the string and
+ on the glyphs and lines that were laid out. Caches use it as the cost of keeping the renderer around.
+ */
+- (NSUInteger)estimatedCost;
+
+/*
+ The part of the constrained rect that the text and its shadow are drawn into. Its size is the same as -size; its origin
+ is away from zero when the text is aligned away from the leading edge.
+ */
+- (CGRect)drawnRect;
+
+/*
+ Whether the text had to be truncated to fit the constrained size, i.e. it is not shown as a single range covering the
+ whole string. Computed along with the size, so it is cheap to call.
+ */
+- (BOOL)isTruncated;
+
 #pragma mark - Text Ranges
 
 /*
@@ -77,7 +98,7 @@ dvlkferufedgjnhjjfhldjedlunvtdtv
 - (std::vector<NSRange>)visibleRanges;
 
 /*
- The number of lines shown in the string.
+ The number of lines shown in the string. Computed along with the size, so it is cheap to call.
  */
 - (NSUInteger)lineCount;
 
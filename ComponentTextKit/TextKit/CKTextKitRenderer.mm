@@ -30,8 +30,20 @@ static NSCharacterSet *_defaultAvoidTruncationCharacterSet()
   return truncationCharacterSet;
 }
 
+/*
+ A rough model of what TextKit keeps alive per renderer: a fixed set of TextKit objects, the UTF-16 backing store of the
+ text storage, the glyph, property and location arrays of the layout manager, and one line fragment record per line.
+ */
+static const NSUInteger kFixedCost = 2048;
+static const NSUInteger kCostPerGlyph = 16;
+static const NSUInteger kCostPerLine = 128;
+
 @implementation CKTextKitRenderer {
   CGSize _calculatedSize;
+  CGRect _drawnRect;
+  BOOL _truncated;
+  NSUInteger _lineCount;
+  NSUInteger _estimatedCost;
 }
 
 #pragma mark - Initialization
@@ -42,6 +54,7 @@ static NSCharacterSet *_defaultAvoidTruncationCharacterSet()
   if (self = [super init]) {
     _constrainedSize = constrainedSize;
     _attributes = attributes;
+    _attributesHash = _attributes.hash();
 
     _shadower = [[CKTextKitShadower alloc] initWithShadowOffset:attributes.shadowOffset
                                                     shadowColor:attributes.shadowColor
@@ -79,15 +92,37 @@ static NSCharacterSet *_defaultAvoidTruncationCharacterSet()
 
   CGRect constrainedRect = {CGPointZero, _constrainedSize};
   __block CGRect boundingRect;
+  __block NSUInteger glyphCount;
+  __block NSUInteger characterCount;
   [_context performBlockWithLockedTextKitComponents:^(NSLayoutManager *layoutManager, NSTextStorage *textStorage, NSTextContainer *textContainer) {
     boundingRect = [layoutManager usedRectForTextContainer:textContainer];
+    glyphCount = [layoutManager numberOfGlyphs];
+    characterCount = textStorage.length;
   }];
+  // Counting lines walks every line fragment under the TextKit lock, so it is only done once.
+  __block NSUInteger lineCount = 0;
+  [_context performBlockWithLockedTextKitComponents:^(NSLayoutManager *layoutManager, NSTextStorage *textStorage, NSTextContainer *textContainer) {
+    for (NSRange lineRange = { 0, 0 }; NSMaxRange(lineRange) < [layoutManager numberOfGlyphs]; lineCount++) {
+      [layoutManager lineFragmentRectForGlyphAtIndex:NSMaxRange(lineRange) effectiveRange:&lineRange];
+    }
+  }];
+  _lineCount = lineCount;
+  _estimatedCost = kFixedCost + characterCount * sizeof(unichar) + glyphCount * kCostPerGlyph + _lineCount * kCostPerLine;
+
+  // Truncation replaces the end of the text storage, so compare the visible range with the original string.
+  const std::vector<NSRange> visibleRanges = _truncater.visibleRanges;
+  _truncated = !(visibleRanges.size() == 1
+                 && visibleRanges[0].location == 0
+                 && visibleRanges[0].length == _attributes.attributedString.length);
 
   // TextKit often returns incorrect glyph bounding rects in the horizontal direction, so we clip to our bounding rect
   // to make sure our width calculations aren't being offset by glyphs going beyond the constrained rect.
   boundingRect = CGRectIntersection(boundingRect, {.size = constrainedRect.size});
 
   _calculatedSize = [_shadower outsetSizeWithInsetSize:boundingRect.size];
+  // The shadow padding pushes the text in by as much as it extends the drawing, so the drawn rect starts where the used
+  // rect does.
+  _drawnRect = {CGRectIsNull(boundingRect) ? CGPointZero : boundingRect.origin, _calculatedSize};
 }
 
 - (CGSize)size
@@ -95,6 +130,21 @@ static NSCharacterSet *_defaultAvoidTruncationCharacterSet()
   return _calculatedSize;
 }
 
+- (NSUInteger)estimatedCost
+{
+  return _estimatedCost;
+}
+
+- (CGRect)drawnRect
+{
+  return _drawnRect;
+}
+
+- (BOOL)isTruncated
+{
+  return _truncated;
+}
+
 #pragma mark - Drawing
 
 - (void)drawInContext:(CGContextRef)context bounds:(CGRect)bounds;
@@ -122,13 +172,7 @@ static NSCharacterSet *_defaultAvoidTruncationCharacterSet()
 
 - (NSUInteger)lineCount
 {
-  __block NSUInteger lineCount = 0;
-  [_context performBlockWithLockedTextKitComponents:^(NSLayoutManager *layoutManager, NSTextStorage *textStorage, NSTextContainer *textContainer) {
-    for (NSRange lineRange = { 0, 0 }; NSMaxRange(lineRange) < [layoutManager numberOfGlyphs]; lineCount++) {
-      [layoutManager lineFragmentRectForGlyphAtIndex:NSMaxRange(lineRange) effectiveRange:&lineRange];
-    }
-  }];
-  return lineCount;
+  return _lineCount;
 }
 
 - (std::vector<NSRange>)visibleRanges
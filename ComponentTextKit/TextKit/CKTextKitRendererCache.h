@@ -8,6 +8,9 @@
  *
  */
 
+#import <algorithm>
+#import <atomic>
+
 #import <Foundation/Foundation.h>
 
 #import <ComponentKit/CKCacheImpl.h>
@@ -66,7 +69,8 @@ namespace CK {
         CKTextKitAttributes attributes;
         CGSize constrainedSize;
 
-        Key(CKTextKitAttributes a, CGSize cs);
+        /** attributesHash must be a.hash(); it is passed in so that callers holding immutable attributes compute it once. */
+        Key(const CKTextKitAttributes &a, size_t attributesHash, CGSize cs);
 
         size_t hash;
 
@@ -86,6 +90,17 @@ namespace CK {
         }
       };
 
+      /** A snapshot of what a cache retains, in the same units as the costs objects are cached with. */
+      struct Usage {
+        NSUInteger retainedCost;
+        NSUInteger maxCost;
+        NSUInteger preferredMaxCost;
+        size_t count;
+      };
+
+      /** How long the budget of a cache stays reduced after a memory warning before it starts growing again. */
+      static const CFTimeInterval kMaxCostRecoveryInterval = 30;
+
       /*
        This is a thin wrapper around a c++ cache and a mutex.  It wraps the bare minimum of calls we need for this case
        with a simple mutex, and observes for memory warnings and backgrounding notifications so that we compact or evict
@@ -110,30 +125,56 @@ namespace CK {
        should likely be a couple MB.  If you are storing renderers it's a good idea to have it related to the visible
        length of the string (as a proxy for number of glyph artifacts).  For an example of usage please see ASTextNode
        or CKTextComponent.
+
+       The key type is a parameter so that caches of artifacts that depend on more than the constrained size, such as
+       raster buffers, can key them precisely; Cache is the cache keyed by attributes and constrained size.
        */
-      struct Cache {
+      template <typename KeyT, typename KeyHasherT>
+      struct CacheT {
       private:
-        CK::ConcurrentCacheImpl<const Key, id, KeyHasher> cache;
+        CK::ConcurrentCacheImpl<const KeyT, id, KeyHasherT> cache;
         ApplicationObserver *applicationObserver;
+        const NSUInteger preferredMaxCost;
+        std::atomic<NSUInteger> maxCost;
+        std::atomic<CFAbsoluteTime> lastMaxCostChangeTime;
+
+        void restoreMaxCostIfNeeded()
+        {
+          const NSUInteger currentMaxCost = maxCost.load();
+          if (currentMaxCost >= preferredMaxCost) {
+            return;
+          }
+          const CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+          if (now - lastMaxCostChangeTime.load() < kMaxCostRecoveryInterval) {
+            return;
+          }
+          // Racing inserts may both double the budget; it is clamped, and a second memory warning shrinks it again.
+          const NSUInteger restoredMaxCost = std::min(preferredMaxCost, currentMaxCost * 2);
+          maxCost = restoredMaxCost;
+          lastMaxCostChangeTime = now;
+          cache.setMaxCost(restoredMaxCost);
+        }
 
       public:
-        Cache(const std::string cacheName, const NSUInteger maxCost, const CGFloat compactionFactor) : cache(cacheName, maxCost, compactionFactor) {
+        CacheT(const std::string cacheName, const NSUInteger maxCost, const CGFloat compactionFactor) :
+        cache(cacheName, maxCost, compactionFactor), preferredMaxCost(maxCost), maxCost(maxCost), lastMaxCostChangeTime(0) {
           applicationObserver = new ApplicationObserver([this] {
-            compact(0.95);
+            didReceiveMemoryWarning();
           }, [this] {
             removeAllObjects();
           });
         };
 
-        ~Cache() {
+        ~CacheT() {
           delete applicationObserver;
         }
 
-        void cacheObject(const Key &key, id object, size_t cost) {
+        void cacheObject(const KeyT &key, id object, size_t cost) {
+          restoreMaxCostIfNeeded();
           cache.insert(key, object, cost);
         }
 
-        const id objectForKey(const Key &key) {
+        const id objectForKey(const KeyT &key) {
           return cache.find(key);
         }
 
@@ -144,7 +185,32 @@ namespace CK {
         void removeAllObjects() {
           cache.removeAllObjects();
         }
+
+        /**
+         Halves the cost budget, down to an eighth of the one the cache was created with, and evicts most objects. The
+         budget grows back a step at a time once memory warnings stop arriving.
+         */
+        void didReceiveMemoryWarning()
+        {
+          const NSUInteger reducedMaxCost = std::max(preferredMaxCost / 8, maxCost.load() / 2);
+          maxCost = reducedMaxCost;
+          lastMaxCostChangeTime = CFAbsoluteTimeGetCurrent();
+          cache.setMaxCost(reducedMaxCost);
+          compact(0.95);
+        }
+
+        Usage usage()
+        {
+          return {
+            .retainedCost = cache.totalCost(),
+            .maxCost = maxCost.load(),
+            .preferredMaxCost = preferredMaxCost,
+            .count = cache.count(),
+          };
+        }
       };
+
+      typedef CacheT<Key, KeyHasher> Cache;
     };
   };
 };
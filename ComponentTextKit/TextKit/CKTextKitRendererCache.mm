@@ -10,8 +10,6 @@
 
 #import <ComponentKit/CKTextKitRendererCache.h>
 
-#import <ComponentKit/CKInternalHelpers.h>
-
 namespace CK {
   namespace TextKit {
     void lowMemoryNotificationHandler(CFNotificationCenterRef center, void *observer, CFStringRef name, const void *object, CFDictionaryRef userInfo) {
@@ -25,14 +23,11 @@ namespace CK {
     }
 
     namespace Renderer {
-      Key::Key(CKTextKitAttributes a, CGSize cs) : attributes(a), constrainedSize(cs) {
+      Key::Key(const CKTextKitAttributes &a, size_t attributesHash, CGSize cs) : attributes(a), constrainedSize(cs) {
         // Precompute hash to avoid paying cost every time getHash is called.
-        NSUInteger subhashes[] = {
-          attributes.hash(),
-          std::hash<CGFloat>()(constrainedSize.width),
-          std::hash<CGFloat>()(constrainedSize.height)
-        };
-        hash = CKIntegerArrayHash(subhashes, sizeof(subhashes) / sizeof(subhashes[0]));
+        size_t sizeHash = std::hash<CGFloat>()(constrainedSize.width);
+        sizeHash ^= std::hash<CGFloat>()(constrainedSize.height) + 0x9e3779b9 + (sizeHash << 6) + (sizeHash >> 2);
+        hash = attributesHash ^ (sizeHash + 0x9e3779b9 + (attributesHash << 6) + (attributesHash >> 2));
       }
     }
   }
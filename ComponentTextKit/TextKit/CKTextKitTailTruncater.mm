@@ -13,6 +13,48 @@
 #import <ComponentKit/CKTextKitContext.h>
 #import <ComponentKit/CKTextKitTailTruncater.h>
 
+/** Characters from right-to-left scripts, and the marks that force right-to-left runs. */
+static NSCharacterSet *_rightToLeftCharacterSet()
+{
+  static NSCharacterSet *rightToLeftCharacterSet;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSMutableCharacterSet *mutableCharacterSet = [[NSMutableCharacterSet alloc] init];
+    [mutableCharacterSet addCharactersInRange:NSMakeRange(0x0590, 0x08FF - 0x0590 + 1)];   // Hebrew through Arabic Extended
+    [mutableCharacterSet addCharactersInRange:NSMakeRange(0xFB1D, 0xFDFF - 0xFB1D + 1)];   // Presentation forms
+    [mutableCharacterSet addCharactersInRange:NSMakeRange(0xFE70, 0xFEFF - 0xFE70 + 1)];
+    [mutableCharacterSet addCharactersInRange:NSMakeRange(0x10800, 0x10FFF - 0x10800 + 1)];
+    [mutableCharacterSet addCharactersInRange:NSMakeRange(0x1E800, 0x1EFFF - 0x1E800 + 1)];
+    [mutableCharacterSet addCharactersInString:@"\u200F\u202B\u202E\u2067"];
+    rightToLeftCharacterSet = mutableCharacterSet;
+  });
+  return rightToLeftCharacterSet;
+}
+
+/**
+ Finds the glyph under x on a line by binary search over the glyph locations. Glyph locations only grow along a line
+ without right-to-left runs, so this matches -glyphIndexForPoint:inTextContainer:fractionOfDistanceThroughGlyph: on
+ such lines without having the layout manager hit test every glyph of the line.
+ */
+static NSUInteger _glyphIndexAtXInLeftToRightLine(NSLayoutManager *layoutManager,
+                                                  NSRange lineGlyphRange,
+                                                  CGFloat lineOriginX,
+                                                  CGFloat x)
+{
+  // Invariant: low is the first glyph or starts at or before x; high is past the end or starts after x.
+  NSUInteger low = lineGlyphRange.location;
+  NSUInteger high = NSMaxRange(lineGlyphRange);
+  while (high - low > 1) {
+    const NSUInteger mid = low + (high - low) / 2;
+    if (lineOriginX + [layoutManager locationForGlyphAtIndex:mid].x <= x) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
 @implementation CKTextKitTailTruncater
 {
   __weak CKTextKitContext *_context;
@@ -51,8 +93,9 @@
   NSRange visibleGlyphRange = [layoutManager glyphRangeForBoundingRect:constrainedRect
                                                        inTextContainer:textContainer];
   NSInteger lastVisibleGlyphIndex = (NSMaxRange(visibleGlyphRange) - 1);
+  NSRange lastLineGlyphRange;
   CGRect lastLineRect = [layoutManager lineFragmentRectForGlyphAtIndex:lastVisibleGlyphIndex
-                                                        effectiveRange:NULL];
+                                                        effectiveRange:&lastLineGlyphRange];
   CGRect lastLineUsedRect = [layoutManager lineFragmentUsedRectForGlyphAtIndex:lastVisibleGlyphIndex
                                                                 effectiveRange:NULL];
   NSParagraphStyle *paragraphStyle = [textStorage attributesAtIndex:[layoutManager characterIndexForGlyphAtIndex:lastVisibleGlyphIndex]
@@ -92,9 +135,20 @@
                                 CGRectGetMaxX(translatedTruncationRect));
   CGPoint beginningOfTruncationMessage = CGPointMake(truncationMessageX,
                                                      CGRectGetMidY(translatedTruncationRect));
-  NSUInteger firstClippedGlyphIndex = [layoutManager glyphIndexForPoint:beginningOfTruncationMessage
-                                                        inTextContainer:textContainer
-                                         fractionOfDistanceThroughGlyph:NULL];
+  NSUInteger firstClippedGlyphIndex;
+  const NSRange lastLineCharacterRange = [layoutManager characterRangeForGlyphRange:lastLineGlyphRange actualGlyphRange:NULL];
+  if (leftAligned && [textStorage.string rangeOfCharacterFromSet:_rightToLeftCharacterSet()
+                                                         options:0
+                                                           range:lastLineCharacterRange].location == NSNotFound) {
+    firstClippedGlyphIndex = _glyphIndexAtXInLeftToRightLine(layoutManager,
+                                                             lastLineGlyphRange,
+                                                             CGRectGetMinX(lastLineRect),
+                                                             truncationMessageX);
+  } else {
+    firstClippedGlyphIndex = [layoutManager glyphIndexForPoint:beginningOfTruncationMessage
+                                               inTextContainer:textContainer
+                                fractionOfDistanceThroughGlyph:NULL];
+  }
   NSUInteger firstCharacterIndexToReplace = [layoutManager characterIndexForGlyphAtIndex:firstClippedGlyphIndex];
   CKAssert(firstCharacterIndexToReplace != NSNotFound,
            @"The beginning of the truncation message exclusion rect (%@) didn't intersect any glyphs",
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <ComponentKit/CKAsyncLayer.h>
+#import <ComponentKit/CKMacros.h>
+
+typedef struct {
+  NSUInteger scheduledCount;
+  NSUInteger startedCount;
+  /** Summed over started blocks, from the time each was scheduled to the time it started. */
+  CFTimeInterval totalQueueLatency;
+  CFTimeInterval maximumQueueLatency;
+} CKAsyncDisplaySchedulerStatistics;
+
+/**
+ @summary Runs async display blocks by priority on a bounded number of background threads.
+
+ @desc A block waits until no block of a higher priority is waiting and one of the slots is free, so a burst of prefetch
+ rasterization never holds back on-screen layers by more than the blocks already running. Blocks of the same priority run
+ in the order they were scheduled.
+
+ Blocks are never dropped; a block whose display was canceled while it waited is expected to return promptly.
+ */
+@interface CKAsyncDisplayScheduler : NSObject
+
+/** The scheduler used by CKAsyncLayer, with one slot per active processor core. */
++ (instancetype)sharedScheduler;
+
+/**
+ @param maximumConcurrentBlockCount The number of blocks that may run at the same time.
+ @param targetQueue The concurrent queue the blocks run on.
+ */
+- (instancetype)initWithMaximumConcurrentBlockCount:(NSUInteger)maximumConcurrentBlockCount
+                                        targetQueue:(dispatch_queue_t)targetQueue;
+
+- (instancetype)init CK_NOT_DESIGNATED_INITIALIZER_ATTRIBUTE;
+
+@property (nonatomic, assign, readonly) NSUInteger maximumConcurrentBlockCount;
+
+/** Safe to call from any thread. The automatic priority is not resolved here and is treated as on-screen. */
+- (void)scheduleBlock:(dispatch_block_t)block priority:(CKAsyncLayerDisplayPriority)priority;
+
+- (CKAsyncDisplaySchedulerStatistics)statisticsForPriority:(CKAsyncLayerDisplayPriority)priority;
+
+- (void)resetStatistics;
+
+@end
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import "CKAsyncDisplayScheduler.h"
+
+#import <algorithm>
+#import <deque>
+#import <mutex>
+
+#import <ComponentKit/CKAssert.h>
+
+/** On-screen, near-screen and prefetch; the automatic priority shares the on-screen queue. */
+static const size_t kPriorityCount = 3;
+
+static size_t priorityIndex(CKAsyncLayerDisplayPriority priority)
+{
+  switch (priority) {
+    case CKAsyncLayerDisplayPriorityAutomatic:
+    case CKAsyncLayerDisplayPriorityOnScreen:
+      return 0;
+    case CKAsyncLayerDisplayPriorityNearScreen:
+      return 1;
+    case CKAsyncLayerDisplayPriorityPrefetch:
+      return 2;
+  }
+  return 0;
+}
+
+struct CKAsyncDisplaySchedulerEntry {
+  dispatch_block_t block;
+  CFAbsoluteTime scheduledTime;
+};
+
+@implementation CKAsyncDisplayScheduler
+{
+  dispatch_queue_t _targetQueue;
+  std::mutex _mutex;
+  std::deque<CKAsyncDisplaySchedulerEntry> _pendingEntries[kPriorityCount];
+  CKAsyncDisplaySchedulerStatistics _statistics[kPriorityCount];
+  NSUInteger _runningWorkerCount;
+}
+
++ (instancetype)sharedScheduler
+{
+  static CKAsyncDisplayScheduler *sharedScheduler;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    const NSUInteger coreCount = std::max<NSUInteger>(1, [[NSProcessInfo processInfo] activeProcessorCount]);
+    // Display blocks are CPU bound, so more of them than there are cores would only slow down the ones on screen.
+    sharedScheduler = [[CKAsyncDisplayScheduler alloc] initWithMaximumConcurrentBlockCount:coreCount
+                                                                                targetQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0)];
+  });
+  return sharedScheduler;
+}
+
+- (instancetype)initWithMaximumConcurrentBlockCount:(NSUInteger)maximumConcurrentBlockCount
+                                        targetQueue:(dispatch_queue_t)targetQueue
+{
+  if (self = [super init]) {
+    CKAssert(maximumConcurrentBlockCount > 0, @"A scheduler without slots would never run anything");
+    _maximumConcurrentBlockCount = maximumConcurrentBlockCount;
+    _targetQueue = targetQueue;
+    [self resetStatistics];
+  }
+  return self;
+}
+
+- (instancetype)init
+{
+  CK_NOT_DESIGNATED_INITIALIZER();
+}
+
+- (void)scheduleBlock:(dispatch_block_t)block priority:(CKAsyncLayerDisplayPriority)priority
+{
+  const size_t index = priorityIndex(priority);
+  BOOL startWorker = NO;
+  {
+    std::lock_guard<std::mutex> l(_mutex);
+    _pendingEntries[index].push_back({[block copy], CFAbsoluteTimeGetCurrent()});
+    _statistics[index].scheduledCount++;
+    if (_runningWorkerCount < _maximumConcurrentBlockCount) {
+      _runningWorkerCount++;
+      startWorker = YES;
+    }
+  }
+  if (startWorker) {
+    dispatch_async(_targetQueue, ^{
+      [self _runPendingBlocks];
+    });
+  }
+}
+
+- (CKAsyncDisplaySchedulerStatistics)statisticsForPriority:(CKAsyncLayerDisplayPriority)priority
+{
+  std::lock_guard<std::mutex> l(_mutex);
+  return _statistics[priorityIndex(priority)];
+}
+
+- (void)resetStatistics
+{
+  std::lock_guard<std::mutex> l(_mutex);
+  for (size_t i = 0; i < kPriorityCount; i++) {
+    _statistics[i] = {};
+  }
+}
+
+#pragma mark - Workers
+
+/** Each worker holds one slot and keeps taking the most urgent block until none is left. */
+- (void)_runPendingBlocks
+{
+  while (true) {
+    dispatch_block_t block;
+    {
+      std::lock_guard<std::mutex> l(_mutex);
+      size_t index = 0;
+      while (index < kPriorityCount && _pendingEntries[index].empty()) {
+        index++;
+      }
+      if (index == kPriorityCount) {
+        _runningWorkerCount--;
+        return;
+      }
+      const CKAsyncDisplaySchedulerEntry entry = _pendingEntries[index].front();
+      _pendingEntries[index].pop_front();
+
+      const CFTimeInterval queueLatency = CFAbsoluteTimeGetCurrent() - entry.scheduledTime;
+      CKAsyncDisplaySchedulerStatistics &statistics = _statistics[index];
+      statistics.startedCount++;
+      statistics.totalQueueLatency += queueLatency;
+      statistics.maximumQueueLatency = std::max(statistics.maximumQueueLatency, queueLatency);
+      block = entry.block;
+    }
+    @autoreleasepool {
+      block();
+    }
+  }
+}
+
+@end
@@ -19,6 +19,19 @@ typedef NS_ENUM(NSUInteger, CKAsyncLayerDisplayMode) {
   CKAsyncLayerDisplayModeAlwaysSync,
 };
 
+typedef NS_ENUM(NSUInteger, CKAsyncLayerDisplayPriority) {
+  /**
+   Inferred at each display: on-screen if the layer intersects its window, near-screen if it is within a screen of it,
+   prefetch if it is further away or not in a window at all.
+   */
+  CKAsyncLayerDisplayPriorityAutomatic,
+  /** Drawn before any other pending async display. */
+  CKAsyncLayerDisplayPriorityOnScreen,
+  CKAsyncLayerDisplayPriorityNearScreen,
+  /** Only drawn when no on-screen or near-screen display is waiting. */
+  CKAsyncLayerDisplayPriorityPrefetch,
+};
+
 @interface CKAsyncLayer : CALayer
 
 /**
@@ -28,6 +41,19 @@ typedef NS_ENUM(NSUInteger, CKAsyncLayerDisplayMode) {
  */
 @property (atomic, assign) CKAsyncLayerDisplayMode displayMode;
 
+/**
+ @summary Orders the async display of the layer against that of other layers waiting for a display slot.
+
+ @default CKAsyncLayerDisplayPriorityAutomatic
+ */
+@property (atomic, assign) CKAsyncLayerDisplayPriority displayPriority;
+
+/**
+ @summary How long the last async display of the layer waited for a display slot before it started drawing.
+ Only read on the main thread.
+ */
+@property (nonatomic, assign, readonly) CFTimeInterval lastAsyncDisplayQueueLatency;
+
 /**
  @summary Captures parameters from the receiver on the main thread that will be passed to drawInContext:parameters:
  on a background queue.  Override to capture values from any properties that are needed for drawing.
@@ -16,6 +16,7 @@
 
 #import <ComponentKit/CKAssert.h>
 
+#import "CKAsyncDisplayScheduler.h"
 #import "CKAsyncTransaction.h"
 #import "CKAsyncTransactionContainer.h"
 
@@ -39,10 +40,17 @@
   return displayQueue;
 }
 
++ (CKAsyncDisplayScheduler *)displayScheduler
+{
+  return [CKAsyncDisplayScheduler sharedScheduler];
+}
+
 + (id)defaultValueForKey:(NSString *)key
 {
   if ([key isEqualToString:@"displayMode"]) {
     return @(CKAsyncLayerDisplayModeDefault);
+  } else if ([key isEqualToString:@"displayPriority"]) {
+    return @(CKAsyncLayerDisplayPriorityAutomatic);
   } else {
     return [super defaultValueForKey:key];
   }
@@ -56,6 +64,7 @@
 }
 
 @dynamic displayMode;
+@dynamic displayPriority;
 
 - (void)setNeedsDisplay
 {
@@ -119,8 +128,20 @@
       CGContextFillRect(bitmapContext, bounds);
     }
 
+    // The display may have been canceled while the bitmap was being allocated or after it was drawn; either way there is
+    // no point in spending more time on it.
+    if ((displaySentinel != nil) && (*displaySentinel != expectedDisplaySentinelValue)) {
+      UIGraphicsEndImageContext();
+      return nil;
+    }
+
     [drawingDelegate drawAsyncLayerInContext:bitmapContext parameters:drawParameters];
 
+    if ((displaySentinel != nil) && (*displaySentinel != expectedDisplaySentinelValue)) {
+      UIGraphicsEndImageContext();
+      return nil;
+    }
+
     CGImageRef image = CGBitmapContextCreateImage(bitmapContext);
     UIGraphicsEndImageContext();
 
@@ -132,6 +153,17 @@
 {
   CKAssertMainThread();
 
+  if (!CGRectIsEmpty(self.bounds)) {
+    id contents = [self contentsWithoutDrawingWithDrawParameters:[self drawParameters]];
+    if (contents) {
+      // Nothing to draw, so any display still in flight would only overwrite these contents with older ones.
+      [self cancelAsyncDisplay];
+      _needsAsyncDisplayOnly = NO;
+      self.contents = contents;
+      return;
+    }
+  }
+
   BOOL renderSynchronously = NO;
   CALayer *parentTransactionContainer;
 
@@ -175,11 +207,12 @@
     return;
   }
 
+  const CGRect displayBounds = {bounds.origin, [self asyncDisplaySizeWithDrawParameters:drawParameters]};
   int32_t displaySentinelValue = OSAtomicIncrement32(&_displaySentinel);
   CALayer *containerLayer = parentTransactionContainer ?: self;
   CKAsyncTransaction *transaction = containerLayer.ck_asyncTransaction;
   CKAssertNotNil(transaction, @"Expected async layer transaction to be non-nil");
-  ck_async_transaction_operation_block_t transactionBlock = [[self class] asyncDisplayBlockWithBounds:bounds
+  ck_async_transaction_operation_block_t transactionBlock = [[self class] asyncDisplayBlockWithBounds:displayBounds
                                                                                         contentsScale:self.contentsScale
                                                                                                opaque:self.opaque
                                                                                       backgroundColor:self.backgroundColor
@@ -187,14 +220,55 @@
                                                                          expectedDisplaySentinelValue:displaySentinelValue
                                                                                       drawingDelegate:(id<CKAsyncLayerDrawingDelegate>)[self class]
                                                                                        drawParameters:drawParameters];
+  const CKAsyncLayerDisplayPriority priority = [self _resolvedDisplayPriority];
+  const CFAbsoluteTime displayTime = CFAbsoluteTimeGetCurrent();
+  // Written on the display thread before the operation completes, read on the main thread in the completion block.
+  __block CFTimeInterval queueLatency = 0;
   ck_async_transaction_operation_completion_block_t completionBlock = ^(id<NSObject> value, BOOL canceled) {
     CKCAssertMainThread();
+    _lastAsyncDisplayQueueLatency = queueLatency;
     if (!canceled && (_displaySentinel == displaySentinelValue)) {
       [self didDisplayAsynchronously:value withDrawParameters:drawParameters];
       self.contents = value;
     }
   };
-  [transaction addOperationWithBlock:transactionBlock queue:[[self class] displayQueue] completion:completionBlock];
+  CKAsyncDisplayScheduler *scheduler = [[self class] displayScheduler];
+  // The transaction only hands the block over to the scheduler, which decides when it gets a thread to draw on.
+  [transaction addAsyncOperationWithBlock:^(ck_async_transaction_complete_async_operation_block_t completeOperation) {
+    [scheduler scheduleBlock:^{
+      queueLatency = CFAbsoluteTimeGetCurrent() - displayTime;
+      completeOperation(transactionBlock());
+    } priority:priority];
+  } queue:[[self class] displayQueue] completion:completionBlock];
+}
+
+- (CKAsyncLayerDisplayPriority)_resolvedDisplayPriority
+{
+  const CKAsyncLayerDisplayPriority displayPriority = self.displayPriority;
+  if (displayPriority != CKAsyncLayerDisplayPriorityAutomatic) {
+    return displayPriority;
+  }
+  CALayer *rootLayer = self;
+  while (rootLayer.superlayer) {
+    rootLayer = rootLayer.superlayer;
+  }
+  if (![rootLayer.delegate isKindOfClass:[UIWindow class]]) {
+    return CKAsyncLayerDisplayPriorityPrefetch;
+  }
+  const CGRect windowBounds = rootLayer.bounds;
+  const CGRect rectInWindow = [self convertRect:self.bounds toLayer:rootLayer];
+  if (CGRectIntersectsRect(rectInWindow, windowBounds)) {
+    return CKAsyncLayerDisplayPriorityOnScreen;
+  }
+  if (CGRectIntersectsRect(rectInWindow, CGRectInset(windowBounds, -windowBounds.size.width, -windowBounds.size.height))) {
+    return CKAsyncLayerDisplayPriorityNearScreen;
+  }
+  return CKAsyncLayerDisplayPriorityPrefetch;
+}
+
+- (id)contentsWithoutDrawingWithDrawParameters:(id<NSObject>)drawParameters
+{
+  return nil;
 }
 
 - (id)willDisplayAsynchronouslyWithDrawParameters:(id<NSObject>)drawParameters
@@ -206,6 +280,11 @@
 {
 }
 
+- (CGSize)asyncDisplaySizeWithDrawParameters:(id<NSObject>)drawParameters
+{
+  return self.bounds.size;
+}
+
 #pragma mark - Drawing
 
 /// this method exists to provide an override point for ASDisplayNodeAsyncLayer where it can use its asyncDelegate in place
@@ -11,6 +11,7 @@
 #import <ComponentKit/CKAsyncLayer.h>
 #import <ComponentKit/CKAsyncTransaction.h>
 
+@class CKAsyncDisplayScheduler;
 @class CKAsyncTransaction;
 
 @protocol CKAsyncLayerDrawingDelegate
@@ -29,6 +30,13 @@
  */
 + (dispatch_queue_t)displayQueue;
 
+/**
+ @summary The scheduler that decides when async display blocks get to draw.
+
+ @desc Blocks are handed to it from the display queue, so the display queue itself never does any drawing.
+ */
++ (CKAsyncDisplayScheduler *)displayScheduler;
+
 + (ck_async_transaction_operation_block_t)asyncDisplayBlockWithBounds:(CGRect)bounds
                                                         contentsScale:(CGFloat)contentsScale
                                                                opaque:(BOOL)opaque
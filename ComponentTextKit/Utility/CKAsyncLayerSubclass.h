@@ -12,6 +12,15 @@
 
 @interface CKAsyncLayer (Subclass)
 
+/**
+ Called on the main thread at the start of every display pass, whether it would draw synchronously or asynchronously.
+ Override to provide contents that are already available without drawing. Defaults to nil.
+
+ @param drawParameters The draw parameters returned from -drawParameters.
+ @return A CGImageRef to set as contents instead of drawing, or nil to display as usual.
+ */
+- (id)contentsWithoutDrawingWithDrawParameters:(id<NSObject>)drawParameters;
+
 /**
  Called on the main thread just before an async display operation is begun.
  Override in a subclass if you desire.
@@ -30,4 +39,13 @@
  */
 - (void)didDisplayAsynchronously:(id)newContents withDrawParameters:(id<NSObject>)drawParameters;
 
+/**
+ Called on the main thread to size the bitmap an async display operation draws into. Defaults to the size of the bounds.
+ Override to draw less than the bounds when the drawing doesn't cover them; the subclass is then responsible for laying
+ out the smaller contents, for instance with contentsCenter.
+
+ @param drawParameters The draw parameters returned from -drawParameters that will be passed to the async operation.
+ */
+- (CGSize)asyncDisplaySizeWithDrawParameters:(id<NSObject>)drawParameters;
+
 @end
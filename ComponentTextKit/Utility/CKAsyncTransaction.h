@@ -17,6 +17,7 @@ typedef id<NSObject>(^ck_async_transaction_operation_block_t)(void);
 typedef void(^ck_async_transaction_operation_completion_block_t)(id<NSObject> value, BOOL canceled);
 typedef void(^ck_async_transaction_complete_async_operation_block_t)(id<NSObject> value);
 typedef void(^ck_async_transaction_async_operation_block_t)(ck_async_transaction_complete_async_operation_block_t completeOperationBlock);
+typedef void(^ck_async_transaction_completion_scheduler_block_t)(CKAsyncTransaction *transaction, dispatch_block_t completeTransaction);
 
 /**
  State is initially CKAsyncTransactionStateOpen.
@@ -65,6 +66,14 @@ typedef NS_ENUM(NSUInteger, CKAsyncTransactionState) {
  */
 @property (nonatomic, copy, readonly) ck_async_transaction_completion_block_t completionBlock;
 
+/**
+ @summary Decides when the completion blocks run once all operations have finished. May be nil.
+
+ @desc When set, it is called on callbackQueue instead of the operation and transaction completion blocks, with a block
+ that runs them. It must call that block exactly once, on callbackQueue. Set it before committing the transaction.
+ */
+@property (nonatomic, copy) ck_async_transaction_completion_scheduler_block_t completionScheduler;
+
 /**
  The state of the transaction.
  @see CKAsyncTransactionState
@@ -139,25 +139,41 @@
 
   if ([_operations count] == 0) {
     // Fast path: if a transaction was opened, but no operations were added, execute completion block synchronously.
-    if (_completionBlock) {
-      _completionBlock(self, NO);
-    }
+    [self _scheduleCompletion:^{
+      if (_completionBlock) {
+        _completionBlock(self, NO);
+      }
+    }];
   } else {
     CKAssert(_group != NULL, @"If there are operations, dispatch group should have been created");
     dispatch_group_notify(_group, _callbackQueue, ^{
-      BOOL isCanceled = (_state == CKAsyncTransactionStateCanceled);
-      for (CKAsyncTransactionOperation *operation in _operations) {
-        [operation callAndReleaseCompletionBlock:isCanceled];
-      }
-      if (_completionBlock) {
-        _completionBlock(self, isCanceled);
-      }
+      [self _scheduleCompletion:^{
+        BOOL isCanceled = (_state == CKAsyncTransactionStateCanceled);
+        for (CKAsyncTransactionOperation *operation in _operations) {
+          [operation callAndReleaseCompletionBlock:isCanceled];
+        }
+        if (_completionBlock) {
+          _completionBlock(self, isCanceled);
+        }
+      }];
     });
   }
 }
 
 #pragma mark - Helper Methods
 
+- (void)_scheduleCompletion:(dispatch_block_t)completeTransaction
+{
+  ck_async_transaction_completion_scheduler_block_t completionScheduler = _completionScheduler;
+  if (completionScheduler) {
+    // Released here so that the scheduler does not outlive the one completion it was set for.
+    _completionScheduler = nil;
+    completionScheduler(self, completeTransaction);
+  } else {
+    completeTransaction();
+  }
+}
+
 - (void)_ensureTransactionData
 {
   // Lazily initialize _group and _operations to avoid overhead in the case where no operations are added to the transaction
@@ -14,6 +14,24 @@
 
 @class CKAsyncTransaction;
 
+typedef NS_ENUM(NSUInteger, CKAsyncTransactionGroupCommitMode) {
+  /// The completion blocks of a transaction run as soon as all of its operations have finished.
+  CKAsyncTransactionGroupCommitModeImmediate,
+  /// The completion blocks of finished transactions run in the order the transactions of each container were committed,
+  /// spending at most completionBudgetPerFrame on them in each frame and leaving the rest for the following frames.
+  CKAsyncTransactionGroupCommitModeDeadline,
+};
+
+typedef struct {
+  /// Transactions whose completion blocks ran through the deadline commit mode.
+  NSUInteger completedTransactionCount;
+  /// Transactions whose completion blocks were pushed to a later frame than the one in which they became ready to run,
+  /// either because the frame budget was spent or because an earlier transaction of the same container had not finished.
+  NSUInteger deferredTransactionCount;
+  /// Frames that ended with finished transactions still waiting for their completion blocks to run.
+  NSUInteger deferredFrameCount;
+} CKAsyncTransactionGroupStatistics;
+
 /// A group of transaction container layers, for which the current transactions are committed together at the end of the next runloop tick.
 @interface CKAsyncTransactionGroup : NSObject
 
@@ -39,4 +57,15 @@
 /// @param completionHandler A block that is called on the main thread after all transactions have completed.
 - (void)flushPendingTransactions:(dispatch_block_t)completionHandler;
 
+/// How the completion blocks of transactions committed by the group are run. Applies to transactions committed after it
+/// is changed. Defaults to CKAsyncTransactionGroupCommitModeImmediate.
+@property (nonatomic, assign) CKAsyncTransactionGroupCommitMode commitMode;
+
+/// The main thread time that completion blocks may take per frame in the deadline commit mode. The completion blocks of
+/// one transaction always run together, and at least one transaction completes per frame. Defaults to 4 milliseconds.
+@property (nonatomic, assign) CFTimeInterval completionBudgetPerFrame;
+
+- (CKAsyncTransactionGroupStatistics)statistics;
+- (void)resetStatistics;
+
 @end
@@ -17,10 +17,50 @@
 
 static void _transactionGroupRunLoopObserverCallback(CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info);
 
+static const CFTimeInterval kDefaultCompletionBudgetPerFrame = 0.004;
+
+/// A transaction committed in the deadline commit mode, from its commit until its completion blocks have run.
+@interface CKAsyncTransactionGroupCompletion : NSObject
+@property (nonatomic, strong) CALayer *containerLayer;
+/// Set once all the operations of the transaction have finished.
+@property (nonatomic, copy) dispatch_block_t completeTransaction;
+@property (nonatomic, assign) BOOL deferred;
+@end
+
+@implementation CKAsyncTransactionGroupCompletion
+@end
+
+/// Keeps the display link from retaining the group.
+@interface CKAsyncTransactionGroupDisplayLinkTarget : NSObject
+@property (nonatomic, weak) CKAsyncTransactionGroup *group;
+@end
+
+@interface CKAsyncTransactionGroup ()
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink;
+@end
+
+@implementation CKAsyncTransactionGroupDisplayLinkTarget
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink
+{
+  [_group displayLinkDidFire:displayLink];
+}
+
+@end
+
 @implementation CKAsyncTransactionGroup {
   NSHashTable *_containerLayers;
   NSHashTable *_pendingContainerLayers;
   NSMutableArray *_pendingCompletionHandlers;
+
+  /// Container layer to its committed transactions that have not completed yet, in commit order.
+  NSMapTable *_completionsByContainerLayer;
+  /// Finished transactions in the order they finished, waiting for their completion blocks to run.
+  NSMutableArray *_readyCompletions;
+  CADisplayLink *_displayLink;
+  CFTimeInterval _frameStartTime;
+  CFTimeInterval _frameTimeSpent;
+  CKAsyncTransactionGroupStatistics _statistics;
 }
 
 + (CKAsyncTransactionGroup *)mainTransactionGroup
@@ -91,10 +131,19 @@ static void _transactionGroupRunLoopObserverCallback(CFRunLoopObserverRef observ
     _containerLayers = [[NSHashTable alloc] initWithOptions:NSHashTableStrongMemory|NSHashTableObjectPointerPersonality capacity:0];
     _pendingContainerLayers = [[NSHashTable alloc] initWithOptions:NSHashTableStrongMemory|NSHashTableObjectPointerPersonality capacity:0];
     _pendingCompletionHandlers = [NSMutableArray array];
+    _completionsByContainerLayer = [NSMapTable mapTableWithKeyOptions:NSMapTableStrongMemory|NSMapTableObjectPointerPersonality
+                                                         valueOptions:NSMapTableStrongMemory];
+    _readyCompletions = [NSMutableArray array];
+    _completionBudgetPerFrame = kDefaultCompletionBudgetPerFrame;
   }
   return self;
 }
 
+- (void)dealloc
+{
+  [_displayLink invalidate];
+}
+
 #pragma mark Public methods
 
 - (void)addTransactionContainer:(CALayer *)containerLayer
@@ -126,10 +175,24 @@ static void _transactionGroupRunLoopObserverCallback(CFRunLoopObserverRef observ
   [_pendingCompletionHandlers addObject:completionHandler];
 
   if (shouldTriggerLayout) {
+    // Nothing may wait for a later frame while a flush is pending, so catch up on what was deferred so far.
+    [self _runReadyCompletions];
     [self forceLayoutAndFlushPendingTransactions];
   }
 }
 
+- (CKAsyncTransactionGroupStatistics)statistics
+{
+  CKAssertMainThread();
+  return _statistics;
+}
+
+- (void)resetStatistics
+{
+  CKAssertMainThread();
+  _statistics = (CKAsyncTransactionGroupStatistics){};
+}
+
 #pragma mark Transactions
 
 - (void)commit
@@ -146,11 +209,132 @@ static void _transactionGroupRunLoopObserverCallback(CFRunLoopObserverRef observ
       CKAsyncTransaction *transaction = containerLayer.ck_currentAsyncLayerTransaction;
       containerLayer.ck_currentAsyncLayerTransaction = nil;
       [_pendingContainerLayers addObject:containerLayer];
+      if (_commitMode == CKAsyncTransactionGroupCommitModeDeadline) {
+        [self _deferCompletionOfTransaction:transaction inContainerLayer:containerLayer];
+      }
       [transaction commit];
     }
   }
 }
 
+#pragma mark Deadline commits
+
+- (void)_deferCompletionOfTransaction:(CKAsyncTransaction *)transaction inContainerLayer:(CALayer *)containerLayer
+{
+  CKAsyncTransactionGroupCompletion *completion = [[CKAsyncTransactionGroupCompletion alloc] init];
+  completion.containerLayer = containerLayer;
+
+  NSMutableArray *containerCompletions = [_completionsByContainerLayer objectForKey:containerLayer];
+  if (containerCompletions == nil) {
+    containerCompletions = [NSMutableArray array];
+    [_completionsByContainerLayer setObject:containerCompletions forKey:containerLayer];
+  }
+  [containerCompletions addObject:completion];
+
+  __weak CKAsyncTransactionGroup *weakSelf = self;
+  transaction.completionScheduler = ^(CKAsyncTransaction *finishedTransaction, dispatch_block_t completeTransaction) {
+    CKCAssertMainThread();
+    CKAsyncTransactionGroup *strongSelf = weakSelf;
+    if (strongSelf == nil) {
+      completeTransaction();
+      return;
+    }
+    completion.completeTransaction = completeTransaction;
+    [strongSelf->_readyCompletions addObject:completion];
+    [strongSelf _runReadyCompletionsWithinBudget];
+  };
+}
+
+/// The first finished transaction whose container has no earlier transaction still waiting.
+- (CKAsyncTransactionGroupCompletion *)_nextRunnableCompletion
+{
+  for (CKAsyncTransactionGroupCompletion *completion in _readyCompletions) {
+    if ([[_completionsByContainerLayer objectForKey:completion.containerLayer] firstObject] == completion) {
+      return completion;
+    }
+  }
+  return nil;
+}
+
+- (void)_runCompletion:(CKAsyncTransactionGroupCompletion *)completion
+{
+  [_readyCompletions removeObject:completion];
+  NSMutableArray *containerCompletions = [_completionsByContainerLayer objectForKey:completion.containerLayer];
+  [containerCompletions removeObjectAtIndex:0];
+  if ([containerCompletions count] == 0) {
+    [_completionsByContainerLayer removeObjectForKey:completion.containerLayer];
+  }
+  _statistics.completedTransactionCount++;
+  dispatch_block_t completeTransaction = completion.completeTransaction;
+  completion.completeTransaction = nil;
+  completeTransaction();
+}
+
+- (void)_runReadyCompletionsWithinBudget
+{
+  if ([_pendingCompletionHandlers count] != 0) {
+    [self _runReadyCompletions];
+    return;
+  }
+
+  const CFTimeInterval now = CACurrentMediaTime();
+  if (_displayLink == nil || _displayLink.paused || now - _frameStartTime >= _displayLink.duration) {
+    // No frame is being paced, or the one that was is over: this is the start of a new frame's budget.
+    _frameStartTime = now;
+    _frameTimeSpent = 0;
+  }
+
+  CKAsyncTransactionGroupCompletion *completion;
+  while (_frameTimeSpent < _completionBudgetPerFrame && (completion = [self _nextRunnableCompletion])) {
+    const CFTimeInterval startTime = CACurrentMediaTime();
+    [self _runCompletion:completion];
+    _frameTimeSpent += CACurrentMediaTime() - startTime;
+  }
+
+  for (CKAsyncTransactionGroupCompletion *waitingCompletion in _readyCompletions) {
+    if (!waitingCompletion.deferred) {
+      waitingCompletion.deferred = YES;
+      _statistics.deferredTransactionCount++;
+    }
+  }
+  if ([self _nextRunnableCompletion] == nil) {
+    // Anything left is waiting for an earlier transaction of its container, which resumes the delivery when it finishes.
+    _displayLink.paused = YES;
+    return;
+  }
+  if (_displayLink == nil) {
+    CKAsyncTransactionGroupDisplayLinkTarget *target = [[CKAsyncTransactionGroupDisplayLinkTarget alloc] init];
+    target.group = self;
+    _displayLink = [CADisplayLink displayLinkWithTarget:target selector:@selector(displayLinkDidFire:)];
+    [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+  }
+  _displayLink.paused = NO;
+}
+
+/// Runs every runnable completion regardless of the frame budget.
+- (void)_runReadyCompletions
+{
+  CKAsyncTransactionGroupCompletion *completion;
+  while ((completion = [self _nextRunnableCompletion])) {
+    [self _runCompletion:completion];
+  }
+  if ([_readyCompletions count] == 0) {
+    _displayLink.paused = YES;
+  }
+}
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink
+{
+  CKAssertMainThread();
+  if ([_readyCompletions count] != 0) {
+    // Whatever is still waiting when a new frame starts was held back by the previous one.
+    _statistics.deferredFrameCount++;
+  }
+  _frameStartTime = CACurrentMediaTime();
+  _frameTimeSpent = 0;
+  [self _runReadyCompletionsWithinBudget];
+}
+
 #pragma mark Flushing
 
 - (void)forceLayoutAndFlushPendingTransactionsIfNeeded
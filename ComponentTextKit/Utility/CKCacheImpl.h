@@ -143,6 +143,13 @@ namespace CK {
 
     void setCompactionFactor(CGFloat newFactor) { _compactionFactor = newFactor; }
 
+    /** Changes the total cost this cache can hold, evicting items right away if it now holds more than that. */
+    void setMaxCost(NSUInteger maxCost)
+    {
+      _maxCost = maxCost;
+      _compactIfNeeded();
+    }
+
     void removeAllObjects()
     {
       _keysToItems.clear();
@@ -606,6 +613,30 @@ namespace CK {
       std::lock_guard<lockPolicy> lg(_l);
       _cacheImpl.removeAllObjects();
     }
+
+    void setMaxCost(NSUInteger maxCost)
+    {
+      std::lock_guard<lockPolicy> lg(_l);
+      _cacheImpl.setMaxCost(maxCost);
+    }
+
+    NSUInteger getMaxCost()
+    {
+      std::lock_guard<lockPolicy> lg(_l);
+      return _cacheImpl.getMaxCost();
+    }
+
+    NSUInteger totalCost()
+    {
+      std::lock_guard<lockPolicy> lg(_l);
+      return _cacheImpl.totalCost();
+    }
+
+    std::size_t count()
+    {
+      std::lock_guard<lockPolicy> lg(_l);
+      return _cacheImpl.count();
+    }
     //constructors
     template <typename ...StrategyArgs>
     ConcurrentCacheImpl(StrategyArgs&&... args) : _cacheImpl(std::forward<StrategyArgs>(args)...)
@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <Foundation/Foundation.h>
+#import <XCTest/XCTest.h>
+
+#import <ComponentKit/CKAsyncDisplayScheduler.h>
+
+@interface CKAsyncDisplaySchedulerTests : XCTestCase
+@end
+
+@implementation CKAsyncDisplaySchedulerTests
+
+- (void)testBlocksWaitingForASlotRunByPriority
+{
+  CKAsyncDisplayScheduler *scheduler =
+  [[CKAsyncDisplayScheduler alloc] initWithMaximumConcurrentBlockCount:1
+                                                           targetQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)];
+  dispatch_semaphore_t slotTaken = dispatch_semaphore_create(0);
+  dispatch_semaphore_t releaseSlot = dispatch_semaphore_create(0);
+  dispatch_group_t group = dispatch_group_create();
+  NSMutableArray *order = [NSMutableArray array];
+
+  dispatch_group_enter(group);
+  [scheduler scheduleBlock:^{
+    dispatch_semaphore_signal(slotTaken);
+    dispatch_semaphore_wait(releaseSlot, DISPATCH_TIME_FOREVER);
+    dispatch_group_leave(group);
+  } priority:CKAsyncLayerDisplayPriorityOnScreen];
+  dispatch_semaphore_wait(slotTaken, DISPATCH_TIME_FOREVER);
+
+  void (^schedule)(NSString *, CKAsyncLayerDisplayPriority) = ^(NSString *name, CKAsyncLayerDisplayPriority priority) {
+    dispatch_group_enter(group);
+    [scheduler scheduleBlock:^{
+      // Only one block runs at a time, so the array needs no lock.
+      [order addObject:name];
+      dispatch_group_leave(group);
+    } priority:priority];
+  };
+  schedule(@"prefetch", CKAsyncLayerDisplayPriorityPrefetch);
+  schedule(@"near", CKAsyncLayerDisplayPriorityNearScreen);
+  schedule(@"on screen 1", CKAsyncLayerDisplayPriorityOnScreen);
+  schedule(@"on screen 2", CKAsyncLayerDisplayPriorityOnScreen);
+
+  dispatch_semaphore_signal(releaseSlot);
+  XCTAssertEqual(dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 5 * NSEC_PER_SEC)), 0);
+  XCTAssertEqualObjects(order, (@[@"on screen 1", @"on screen 2", @"near", @"prefetch"]));
+
+  const CKAsyncDisplaySchedulerStatistics prefetchStatistics = [scheduler statisticsForPriority:CKAsyncLayerDisplayPriorityPrefetch];
+  XCTAssertEqual(prefetchStatistics.scheduledCount, 1u);
+  XCTAssertEqual(prefetchStatistics.startedCount, 1u);
+  XCTAssertGreaterThan(prefetchStatistics.maximumQueueLatency, 0);
+  XCTAssertEqual([scheduler statisticsForPriority:CKAsyncLayerDisplayPriorityOnScreen].startedCount, 3u);
+}
+
+@end
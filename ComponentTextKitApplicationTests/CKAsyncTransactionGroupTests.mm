@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2014-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <ComponentKit/CKAsyncTransaction.h>
+#import <ComponentKit/CKAsyncTransactionContainer+Private.h>
+#import <ComponentKit/CKAsyncTransactionGroup.h>
+
+@interface CKAsyncTransactionGroupTests : XCTestCase
+@end
+
+/** Commits a transaction whose single operation waits for the gate and whose completion block runs the given block. */
+static void commitGatedTransaction(CKAsyncTransactionGroup *group, CALayer *containerLayer,
+                                   dispatch_semaphore_t gate, dispatch_block_t completion)
+{
+  CKAsyncTransaction *transaction =
+  [[CKAsyncTransaction alloc] initWithCallbackQueue:dispatch_get_main_queue()
+                                    completionBlock:^(CKAsyncTransaction *completedTransaction, BOOL canceled) {
+                                      completion();
+                                    }];
+  [transaction addOperationWithBlock:^id<NSObject>{
+    dispatch_semaphore_wait(gate, DISPATCH_TIME_FOREVER);
+    return nil;
+  } queue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) completion:^(id<NSObject> value, BOOL canceled) {}];
+  containerLayer.ck_currentAsyncLayerTransaction = transaction;
+  [group addTransactionContainer:containerLayer];
+  [group commit];
+}
+
+static void runMainRunLoopUntil(BOOL (^condition)(void))
+{
+  NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+  while (!condition() && [timeout timeIntervalSinceNow] > 0) {
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  }
+}
+
+@implementation CKAsyncTransactionGroupTests
+
+- (void)testDeadlineModeCompletesTransactionsOfAContainerInCommitOrder
+{
+  CKAsyncTransactionGroup *group = [[CKAsyncTransactionGroup alloc] init];
+  group.commitMode = CKAsyncTransactionGroupCommitModeDeadline;
+  CALayer *containerLayer = [CALayer layer];
+  dispatch_semaphore_t releaseFirst = dispatch_semaphore_create(0);
+  NSMutableArray *order = [NSMutableArray array];
+
+  void (^commitTransaction)(NSString *, dispatch_semaphore_t) = ^(NSString *name, dispatch_semaphore_t semaphore) {
+    CKAsyncTransaction *transaction =
+    [[CKAsyncTransaction alloc] initWithCallbackQueue:dispatch_get_main_queue()
+                                      completionBlock:^(CKAsyncTransaction *completedTransaction, BOOL canceled) {
+                                        [order addObject:name];
+                                      }];
+    [transaction addOperationWithBlock:^id<NSObject>{
+      if (semaphore) {
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+      }
+      return nil;
+    } queue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) completion:^(id<NSObject> value, BOOL canceled) {}];
+    containerLayer.ck_currentAsyncLayerTransaction = transaction;
+    [group addTransactionContainer:containerLayer];
+    [group commit];
+  };
+  commitTransaction(@"first", releaseFirst);
+  commitTransaction(@"second", nil);
+
+  // Give the second transaction time to finish while the first one is still running.
+  [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+  XCTAssertEqual([order count], 0u);
+
+  dispatch_semaphore_signal(releaseFirst);
+  NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+  while ([order count] < 2 && [timeout timeIntervalSinceNow] > 0) {
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  }
+  XCTAssertEqualObjects(order, (@[@"first", @"second"]));
+
+  const CKAsyncTransactionGroupStatistics statistics = [group statistics];
+  XCTAssertEqual(statistics.completedTransactionCount, 2u);
+  XCTAssertEqual(statistics.deferredTransactionCount, 1u);
+}
+
+static const NSUInteger kSlowTransactionCount = 8;
+/** Each completion block takes several times the budget, so only one of them fits in a frame. */
+static const useconds_t kSlowCompletionMicroseconds = 5000;
+
+- (void)testDeadlineModeSpreadsReadyCompletionsAcrossFrames
+{
+  CKAsyncTransactionGroup *group = [[CKAsyncTransactionGroup alloc] init];
+  group.commitMode = CKAsyncTransactionGroupCommitModeDeadline;
+  group.completionBudgetPerFrame = 0.001;
+  dispatch_semaphore_t gate = dispatch_semaphore_create(0);
+  __block NSUInteger completedCount = 0;
+
+  for (NSUInteger i = 0; i < kSlowTransactionCount; i++) {
+    commitGatedTransaction(group, [CALayer layer], gate, ^{
+      usleep(kSlowCompletionMicroseconds);
+      completedCount++;
+    });
+  }
+  // Let every operation finish at once so that all the transactions are ready in the same frame.
+  for (NSUInteger i = 0; i < kSlowTransactionCount; i++) {
+    dispatch_semaphore_signal(gate);
+  }
+  runMainRunLoopUntil(^{ return (BOOL)(completedCount == kSlowTransactionCount); });
+
+  const CKAsyncTransactionGroupStatistics statistics = [group statistics];
+  XCTAssertEqual(statistics.completedTransactionCount, kSlowTransactionCount);
+  XCTAssertGreaterThan(statistics.deferredFrameCount, 0u);
+  // At least one transaction completes in every frame, so the last frame ends with nothing left waiting.
+  XCTAssertLessThan(statistics.deferredFrameCount, kSlowTransactionCount);
+}
+
+- (void)testDeadlineModeIgnoresTheBudgetWhileAFlushIsPending
+{
+  CKAsyncTransactionGroup *group = [[CKAsyncTransactionGroup alloc] init];
+  group.commitMode = CKAsyncTransactionGroupCommitModeDeadline;
+  group.completionBudgetPerFrame = 0.001;
+  dispatch_semaphore_t gate = dispatch_semaphore_create(0);
+  __block NSUInteger completedCount = 0;
+
+  for (NSUInteger i = 0; i < kSlowTransactionCount; i++) {
+    CALayer *containerLayer = [CALayer layer];
+    commitGatedTransaction(group, containerLayer, gate, ^{
+      usleep(kSlowCompletionMicroseconds);
+      completedCount++;
+      // Async layers leave the group once their transactions are done, which is what lets the flush finish.
+      [group removeTransactionContainer:containerLayer];
+    });
+  }
+  __block BOOL flushed = NO;
+  [group flushPendingTransactions:^{
+    flushed = YES;
+  }];
+  for (NSUInteger i = 0; i < kSlowTransactionCount; i++) {
+    dispatch_semaphore_signal(gate);
+  }
+  runMainRunLoopUntil(^{ return flushed; });
+
+  XCTAssertTrue(flushed);
+  XCTAssertEqual(completedCount, kSlowTransactionCount);
+  const CKAsyncTransactionGroupStatistics statistics = [group statistics];
+  XCTAssertEqual(statistics.completedTransactionCount, kSlowTransactionCount);
+  XCTAssertEqual(statistics.deferredTransactionCount, 0u);
+  XCTAssertEqual(statistics.deferredFrameCount, 0u);
+}
+
+@end
@@ -12,7 +12,13 @@
 
 #import <ComponentKitTestLib/CKComponentSnapshotTestCase.h>
 
+#import <ComponentKit/CKComponentContext.h>
+#import <ComponentKit/CKComponentSubclass.h>
 #import <ComponentKit/CKTextComponent.h>
+#import <ComponentKit/CKTextComponentGlyphAtlas.h>
+#import <ComponentKit/CKTextComponentLayer.h>
+#import <ComponentKit/CKTextComponentRasterizationBudget.h>
+#import <ComponentKit/CKTextKitRenderer.h>
 
 static const CKSizeRange kFlexibleSize = {{0, 0}, {320, 100}};
 
@@ -384,4 +390,129 @@ static NSParagraphStyle *rtlWritingDirectionParagraphStyle() {
   CKSnapshotVerifyComponent(c, kUnrestrictedSize, @"");
 }
 
+- (void)testTextIsRasterizedDuringLayoutWithinTheBudgetInContext
+{
+  CKTextComponentRasterizationBudget *budget = [[CKTextComponentRasterizationBudget alloc] initWithByteLimit:1024 * 1024];
+  CKTextComponentRasterizationBudget *exhaustedBudget = [[CKTextComponentRasterizationBudget alloc] initWithByteLimit:1];
+  CKTextComponent *(^newTextComponent)(NSString *) = ^(NSString *string) {
+    return [CKTextComponent
+            newWithTextAttributes:{.attributedString = [[NSAttributedString alloc] initWithString:string]}
+            viewAttributes:{}
+            accessibilityContext:{}];
+  };
+
+  CKTextComponent *c;
+  {
+    CKComponentContext<CKTextComponentRasterizationBudget> budgetContext(budget);
+    c = newTextComponent(@"Rasterized while laid out");
+  }
+  [c layoutThatFits:kFlexibleSize parentSize:kFlexibleSize.max];
+  XCTAssertEqual(budget.consumedBytes, 0u, @"Text measured at a flexible size may still be laid out at another one");
+
+  const CKSizeRange exactSize = {{320, 100}, {320, 100}};
+  [c layoutThatFits:exactSize parentSize:exactSize.max];
+  const NSUInteger consumedBytes = budget.consumedBytes;
+  XCTAssertGreaterThan(consumedBytes, 0u);
+
+  [c layoutThatFits:exactSize parentSize:exactSize.max];
+  XCTAssertEqual(budget.consumedBytes, consumedBytes, @"Text that is already rasterized should not be drawn again");
+
+  CKTextComponent *overBudget;
+  {
+    CKComponentContext<CKTextComponentRasterizationBudget> budgetContext(exhaustedBudget);
+    overBudget = newTextComponent(@"Too large for the budget");
+  }
+  [overBudget layoutThatFits:exactSize parentSize:exactSize.max];
+  XCTAssertEqual(exhaustedBudget.consumedBytes, 0u);
+}
+
+- (void)testIdenticalTextAtDifferentBoundsSharesOneRaster
+{
+  CKTextComponentRasterizationBudget *budget = [[CKTextComponentRasterizationBudget alloc] initWithByteLimit:1024 * 1024];
+  const CKTextKitAttributes attributes {
+    .attributedString = [[NSAttributedString alloc] initWithString:@"Shared between layouts"]
+  };
+  CKTextKitRenderer *narrow = [[CKTextKitRenderer alloc] initWithTextKitAttributes:attributes
+                                                                   constrainedSize:{300, 100}];
+  CKTextKitRenderer *wide = [[CKTextKitRenderer alloc] initWithTextKitAttributes:attributes
+                                                                 constrainedSize:{320, 200}];
+  XCTAssertTrue(CGRectEqualToRect(narrow.drawnRect, wide.drawnRect));
+
+  XCTAssertTrue([CKTextComponentLayer rasterizeRenderer:narrow backgroundColor:nil budget:budget]);
+  const NSUInteger consumedBytes = budget.consumedBytes;
+  XCTAssertLessThan(consumedBytes, (NSUInteger)(300 * 100 * 4), @"The bitmap should only cover the drawn text");
+  XCTAssertFalse([CKTextComponentLayer rasterizeRenderer:wide backgroundColor:nil budget:budget],
+                 @"Text drawn identically in larger bounds should reuse the existing bitmap");
+  XCTAssertEqual(budget.consumedBytes, consumedBytes);
+}
+
+- (void)testRepeatedShortStringsShareOneGlyphRun
+{
+  CKTextComponentGlyphAtlas *atlas = [[CKTextComponentGlyphAtlas alloc] initWithPagePixelSize:256 maximumPageCount:1];
+  CKTextKitRenderer *(^newRenderer)(NSString *, UIColor *, CGSize) = ^(NSString *string, UIColor *color, CGSize size) {
+    NSAttributedString *attributedString =
+    [[NSAttributedString alloc] initWithString:string
+                                    attributes:@{NSFontAttributeName: [UIFont systemFontOfSize:12],
+                                                 NSForegroundColorAttributeName: color}];
+    return [[CKTextKitRenderer alloc] initWithTextKitAttributes:{.attributedString = attributedString}
+                                                constrainedSize:size];
+  };
+
+  XCTAssertNil([atlas existingGlyphRunForRenderer:newRenderer(@"2h", [UIColor grayColor], {100, 50})
+                                       boundsSize:{100, 50}
+                                            scale:2], @"Looking a run up should never rasterize it");
+  CKTextComponentGlyphRun *first = [atlas glyphRunForRenderer:newRenderer(@"2h", [UIColor grayColor], {100, 50})
+                                                   boundsSize:{100, 50}
+                                                        scale:2];
+  CKTextComponentGlyphRun *second = [atlas glyphRunForRenderer:newRenderer(@"2h", [UIColor grayColor], {60, 20})
+                                                    boundsSize:{60, 20}
+                                                         scale:2];
+  XCTAssertNotNil(first);
+  XCTAssertEqualObjects(first.image, second.image);
+  XCTAssertTrue(CGRectEqualToRect(first.contentsRect, second.contentsRect));
+
+  CKTextComponentGlyphRun *otherColor = [atlas glyphRunForRenderer:newRenderer(@"2h", [UIColor blueColor], {100, 50})
+                                                        boundsSize:{100, 50}
+                                                             scale:2];
+  XCTAssertNotNil(otherColor);
+  XCTAssertNotEqualObjects(first.image, otherColor.image, @"Runs of a page still being filled have images of their own");
+
+  NSString *longString = @"Far too long to be repeated verbatim across a feed of stories";
+  XCTAssertNil([atlas glyphRunForRenderer:newRenderer(longString, [UIColor grayColor], {1000, 50})
+                               boundsSize:{1000, 50}
+                                    scale:2]);
+
+  const CKTextComponentGlyphAtlasStatistics statistics = [atlas statistics];
+  XCTAssertEqual(statistics.runCount, 2u);
+  XCTAssertEqual(statistics.hitCount, 1u);
+  XCTAssertEqual(statistics.pageCount, 1u);
+}
+
+- (void)testRunsShareThePageImageOnceThePageIsFull
+{
+  CKTextComponentGlyphAtlas *atlas = [[CKTextComponentGlyphAtlas alloc] initWithPagePixelSize:128 maximumPageCount:2];
+  CKTextKitRenderer *(^newRenderer)(NSString *) = ^(NSString *string) {
+    NSAttributedString *attributedString =
+    [[NSAttributedString alloc] initWithString:string
+                                    attributes:@{NSFontAttributeName: [UIFont systemFontOfSize:12],
+                                                 NSForegroundColorAttributeName: [UIColor grayColor]}];
+    return [[CKTextKitRenderer alloc] initWithTextKitAttributes:{.attributedString = attributedString}
+                                                constrainedSize:{100, 50}];
+  };
+
+  for (NSUInteger i = 0; [atlas statistics].pageCount < 2 && i < 100; i++) {
+    XCTAssertNotNil([atlas glyphRunForRenderer:newRenderer([NSString stringWithFormat:@"%lu", (unsigned long)i])
+                                    boundsSize:{100, 50}
+                                         scale:2]);
+  }
+  XCTAssertEqual([atlas statistics].pageCount, 2u);
+
+  CKTextComponentGlyphRun *zero = [atlas existingGlyphRunForRenderer:newRenderer(@"0") boundsSize:{100, 50} scale:2];
+  CKTextComponentGlyphRun *one = [atlas existingGlyphRunForRenderer:newRenderer(@"1") boundsSize:{100, 50} scale:2];
+  XCTAssertNotNil(zero);
+  XCTAssertEqualObjects(zero.image, one.image);
+  XCTAssertFalse(CGRectIntersectsRect(zero.contentsRect, one.contentsRect));
+  XCTAssertEqual(CGImageGetWidth((__bridge CGImageRef)zero.image), (size_t)128);
+}
+
 @end
@@ -9,12 +9,20 @@
  */
 
 
+#import <unordered_set>
+
 #import <XCTest/XCTest.h>
 
 #import <FBSnapshotTestCase/FBSnapshotTestController.h>
 
+#import <ComponentKit/CKComponentSubclass.h>
+#import <ComponentKit/CKTextComponent.h>
+
 #import "CKTextKitAttributes.h"
+#import "CKTextKitContext.h"
+#import "CKTextKitMeasurementCache.h"
 #import "CKTextKitRenderer.h"
+#import "CKTextKitRendererCache.h"
 
 @interface CKTextKitTests : XCTestCase
 
@@ -107,4 +115,271 @@ static BOOL checkAttributes(const CKTextKitAttributes &attributes, const CGSize
   XCTAssert(checkAttributes(attributes, { 100, 100 }));
 }
 
+- (void)testMeasurementCacheReusesMeasurementsThatCoverTheConstrainedSize
+{
+  // A headless backend: the text is 100pt wide on a single 20pt line and wraps onto two lines when narrower.
+  NSUInteger backendCalls = 0;
+  CK::TextKit::Measurement::Cache cache("test", 100, 0.2, [&backendCalls](const CKTextKitAttributes &attributes, size_t attributesHash, CGSize constrainedSize) {
+    backendCalls++;
+    const CGSize size = constrainedSize.width >= 100 ? CGSize{100, 20} : CGSize{constrainedSize.width, 40};
+    return CK::TextKit::Measurement::Result {
+      .size = size,
+      .truncated = constrainedSize.height < size.height
+    };
+  });
+  CKTextKitAttributes attributes {
+    .attributedString = [[NSAttributedString alloc] initWithString:@"hello"]
+  };
+  const size_t attributesHash = attributes.hash();
+
+  XCTAssertTrue(CGSizeEqualToSize(cache.sizeForAttributes(attributes, attributesHash, {INFINITY, INFINITY}), CGSizeMake(100, 20)));
+  XCTAssertTrue(CGSizeEqualToSize(cache.sizeForAttributes(attributes, attributesHash, {320, 100}), CGSizeMake(100, 20)));
+  XCTAssertTrue(CGSizeEqualToSize(cache.sizeForAttributes(attributes, attributesHash, {100, 20}), CGSizeMake(100, 20)));
+  XCTAssertEqual(backendCalls, 1u, @"Every width wider than the natural width should reuse the first measurement");
+
+  XCTAssertTrue(CGSizeEqualToSize(cache.sizeForAttributes(attributes, attributesHash, {80, 30}), CGSizeMake(80, 40)));
+  XCTAssertTrue(CGSizeEqualToSize(cache.sizeForAttributes(attributes, attributesHash, {80, 30}), CGSizeMake(80, 40)));
+  XCTAssertEqual(backendCalls, 3u, @"Truncated layouts should never be reused");
+
+  XCTAssertTrue(CGSizeEqualToSize(cache.sizeForAttributes(attributes, attributesHash, {80, 100}), CGSizeMake(80, 40)));
+  XCTAssertTrue(CGSizeEqualToSize(cache.sizeForAttributes(attributes, attributesHash, {80, 40}), CGSizeMake(80, 40)));
+  XCTAssertEqual(backendCalls, 4u);
+
+  const CK::TextKit::Measurement::Statistics statistics = cache.statistics();
+  XCTAssertEqual(statistics.hitCount, 3u);
+  XCTAssertEqual(statistics.missCount, 4u);
+  XCTAssertEqualWithAccuracy(statistics.hitRate(), 3.0 / 7.0, 0.0001);
+}
+
+- (void)testMeasurementCacheMatchesTextKitLayoutAcrossWidths
+{
+  CK::TextKit::Measurement::Cache cache("test", 100, 0.2, [](const CKTextKitAttributes &attributes, size_t attributesHash, CGSize constrainedSize) {
+    return CK::TextKit::Measurement::resultForRenderer([[CKTextKitRenderer alloc] initWithTextKitAttributes:attributes
+                                                                                           constrainedSize:constrainedSize]);
+  });
+  CKTextKitAttributes attributes {
+    .attributedString = [[NSAttributedString alloc] initWithString:@"The quick brown fox jumps over the lazy dog"
+                                                        attributes:@{NSFontAttributeName : [UIFont systemFontOfSize:12]}]
+  };
+  const size_t attributesHash = attributes.hash();
+
+  for (CGFloat width = 320; width >= 40; width -= 1) {
+    const CGSize constrainedSize = {width, 1000};
+    CKTextKitRenderer *renderer = [[CKTextKitRenderer alloc] initWithTextKitAttributes:attributes
+                                                                       constrainedSize:constrainedSize];
+    const CGSize cachedSize = cache.sizeForAttributes(attributes, attributesHash, constrainedSize);
+    XCTAssertTrue(CGSizeEqualToSize(cachedSize, renderer.size), @"Size mismatch at width %f", width);
+  }
+  XCTAssertGreaterThan(cache.statistics().hitRate(), 0.5);
+}
+
+- (void)testMeasurementCacheWithAHeadlessBackendAcrossWidths
+{
+  // A headless backend with fixed-width glyphs that wraps greedily, so only the cache's own work is measured.
+  const CGFloat glyphWidth = 7;
+  const CGFloat lineHeight = 20;
+  const CK::TextKit::Measurement::Backend backend = [=](const CKTextKitAttributes &attributes, size_t attributesHash, CGSize constrainedSize) {
+    const NSUInteger length = attributes.attributedString.length;
+    const NSUInteger glyphsPerLine = MAX((NSUInteger)1, (NSUInteger)(constrainedSize.width / glyphWidth));
+    const NSUInteger lineCount = (length + glyphsPerLine - 1) / glyphsPerLine;
+    const CGSize size = {MIN(length, glyphsPerLine) * glyphWidth, lineCount * lineHeight};
+    return CK::TextKit::Measurement::Result {
+      .size = size,
+      .truncated = constrainedSize.height < size.height
+    };
+  };
+  std::vector<CKTextKitAttributes> attributes;
+  for (NSUInteger i = 0; i < 50; i++) {
+    attributes.push_back({
+      .attributedString = [[NSAttributedString alloc] initWithString:[NSString stringWithFormat:@"Story %lu: the quick brown fox jumps over the lazy dog", (unsigned long)i]]
+    });
+  }
+
+  std::vector<size_t> attributesHashes;
+  for (const auto &a : attributes) {
+    attributesHashes.push_back(a.hash());
+  }
+
+  __block CGFloat hitRate = 0;
+  [self measureBlock:^{
+    CK::TextKit::Measurement::Cache cache("test", 10000, 0.2, backend);
+    for (CGFloat width = 320; width >= 40; width -= 1) {
+      for (size_t i = 0; i < attributes.size(); i++) {
+        (void)cache.sizeForAttributes(attributes[i], attributesHashes[i], {width, CGFLOAT_MAX});
+      }
+    }
+    hitRate = cache.statistics().hitRate();
+  }];
+  XCTAssertGreaterThan(hitRate, 0.5);
+}
+
+- (void)testRendererEstimatedCostGrowsWithTheText
+{
+  NSDictionary *fontAttributes = @{NSFontAttributeName : [UIFont systemFontOfSize:12]};
+  CKTextKitAttributes shortAttributes {
+    .attributedString = [[NSAttributedString alloc] initWithString:@"Like" attributes:fontAttributes]
+  };
+  CKTextKitAttributes longAttributes {
+    .attributedString = [[NSAttributedString alloc] initWithString:[@"" stringByPaddingToLength:5000 withString:@"lorem ipsum " startingAtIndex:0]
+                                                        attributes:fontAttributes]
+  };
+  CKTextKitRenderer *shortRenderer = [[CKTextKitRenderer alloc] initWithTextKitAttributes:shortAttributes constrainedSize:{320, CGFLOAT_MAX}];
+  CKTextKitRenderer *longRenderer = [[CKTextKitRenderer alloc] initWithTextKitAttributes:longAttributes constrainedSize:{320, CGFLOAT_MAX}];
+  XCTAssertGreaterThan(shortRenderer.estimatedCost, 0u);
+  XCTAssertGreaterThan(longRenderer.estimatedCost, 50 * shortRenderer.estimatedCost);
+}
+
+- (void)testRendererCacheShrinksItsBudgetOnMemoryWarnings
+{
+  CK::TextKit::Renderer::Cache cache("test", 1000, 0.2);
+  for (NSUInteger i = 0; i < 10; i++) {
+    CKTextKitAttributes attributes {
+      .attributedString = [[NSAttributedString alloc] initWithString:[NSString stringWithFormat:@"%lu", (unsigned long)i]]
+    };
+    cache.cacheObject({attributes, {100, 100}}, [NSObject new], 100);
+  }
+  CK::TextKit::Renderer::Usage usage = cache.usage();
+  XCTAssertEqual(usage.retainedCost, 1000u);
+  XCTAssertEqual(usage.count, 10u);
+
+  cache.didReceiveMemoryWarning();
+  usage = cache.usage();
+  XCTAssertEqual(usage.maxCost, 500u);
+  XCTAssertEqual(usage.preferredMaxCost, 1000u);
+  XCTAssertLessThanOrEqual(usage.retainedCost, 500u);
+
+  for (NSUInteger i = 0; i < 4; i++) {
+    cache.didReceiveMemoryWarning();
+  }
+  XCTAssertEqual(cache.usage().maxCost, 125u, @"The budget should never drop below an eighth of the preferred budget");
+}
+
+static std::vector<CKTextKitAttributes> attributesSharingPrefixAndSuffix(NSUInteger count, NSUInteger batch = 0)
+{
+  NSString *prefix = [@"" stringByPaddingToLength:300 withString:@"Shared prefix. " startingAtIndex:0];
+  NSString *suffix = [@"" stringByPaddingToLength:1000 withString:@"Shared suffix. " startingAtIndex:0];
+  std::vector<CKTextKitAttributes> attributes;
+  for (NSUInteger i = 0; i < count; i++) {
+    NSString *string = [NSString stringWithFormat:@"%@%lu.%lu%@", prefix, (unsigned long)batch, (unsigned long)i, suffix];
+    attributes.push_back({
+      .attributedString = [[NSAttributedString alloc] initWithString:string
+                                                           attributes:@{NSFontAttributeName : [UIFont systemFontOfSize:12]}]
+    });
+  }
+  return attributes;
+}
+
+- (void)testAttributesHashCoversTheWholeStringAndItsAttributeRuns
+{
+  const std::vector<CKTextKitAttributes> attributes = attributesSharingPrefixAndSuffix(200);
+  std::unordered_set<NSUInteger> stringHashes;
+  std::unordered_set<size_t> attributesHashes;
+  for (const auto &a : attributes) {
+    stringHashes.insert([a.attributedString hash]);
+    attributesHashes.insert(a.hash());
+  }
+  XCTAssertEqual(attributesHashes.size(), attributes.size());
+  XCTAssertLessThan(stringHashes.size(), attributes.size(), @"NSAttributedString hashes are expected to collide here");
+
+  NSMutableAttributedString *bold = [attributes[0].attributedString mutableCopy];
+  [bold addAttribute:NSFontAttributeName value:[UIFont boldSystemFontOfSize:12] range:NSMakeRange(0, 5)];
+  const CKTextKitAttributes boldAttributes {.attributedString = bold};
+  XCTAssertNotEqual(boldAttributes.hash(), attributes[0].hash());
+
+  const CKTextKitAttributes equalAttributes {.attributedString = [attributes[0].attributedString mutableCopy]};
+  XCTAssertEqual(equalAttributes.hash(), attributes[0].hash());
+  XCTAssertTrue(equalAttributes == attributes[0]);
+}
+
+- (void)testAttributesModifiedAfterBeingHashedStillCompareByContents
+{
+  CKTextKitAttributes attributes {.attributedString = [[NSAttributedString alloc] initWithString:@"Before"]};
+  const CKTextKitAttributes other {.attributedString = [[NSAttributedString alloc] initWithString:@"After"]};
+  const size_t hashBefore = attributes.hash();
+  XCTAssertFalse(attributes == other);
+
+  attributes.attributedString = [[NSAttributedString alloc] initWithString:@"After"];
+  XCTAssertTrue(attributes == other, @"Expected a previously computed hash not to be used once the attributes changed");
+  XCTAssertEqual(attributes.hash(), other.hash());
+  XCTAssertNotEqual(attributes.hash(), hashBefore);
+}
+
+struct CountingKeyEqual {
+  NSUInteger *fullComparisonCount;
+
+  bool operator()(const CK::TextKit::Renderer::Key &a, const CK::TextKit::Renderer::Key &b) const
+  {
+    if (a.hash != b.hash) {
+      return false;
+    }
+    (*fullComparisonCount)++;
+    return a == b;
+  }
+};
+
+- (void)testRendererKeysForStringsSharingAPrefixAreComparedOnlyOnHashMatches
+{
+  const std::vector<CKTextKitAttributes> attributes = attributesSharingPrefixAndSuffix(500);
+  std::vector<size_t> attributesHashes;
+  for (const auto &a : attributes) {
+    attributesHashes.push_back(a.hash());
+  }
+  __block NSUInteger fullComparisonCount = 0;
+  [self measureBlock:^{
+    fullComparisonCount = 0;
+    std::unordered_set<CK::TextKit::Renderer::Key, CK::TextKit::Renderer::KeyHasher, CountingKeyEqual> keys(0, {}, {&fullComparisonCount});
+    for (size_t i = 0; i < attributes.size(); i++) {
+      keys.insert({attributes[i], attributesHashes[i], {320, CGFLOAT_MAX}});
+    }
+    for (size_t i = 0; i < attributes.size(); i++) {
+      XCTAssertEqual(keys.count({attributes[i], attributesHashes[i], {320, CGFLOAT_MAX}}), 1u);
+    }
+  }];
+  XCTAssertEqual(fullComparisonCount, attributes.size(), @"Only the lookups that actually match should compare strings");
+}
+
+- (void)testTextKitComponentsAreReusedAcrossABatchOfCells
+{
+  // More long posts than the renderer cache holds, so that it evicts renderers (and releases their contexts) on
+  // whichever thread inserts the next one while the batch is still being laid out.
+  const NSUInteger batchSize = 400;
+  __block NSUInteger batch = 0;
+  [self measureBlock:^{
+    // Every pass lays out new strings, so that nothing is answered by the measurement or renderer caches.
+    const std::vector<CKTextKitAttributes> attributes = attributesSharingPrefixAndSuffix(batchSize, batch++);
+    CKTextKitContextResetStatistics();
+    dispatch_apply(attributes.size(), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+      CKTextComponent *component = [CKTextComponent newWithTextAttributes:attributes[i]
+                                                           viewAttributes:{}
+                                                     accessibilityContext:{}];
+      (void)[component layoutThatFits:{{0, 0}, {320, INFINITY}} parentSize:{320, INFINITY}];
+    });
+    const CKTextKitContextStatistics statistics = CKTextKitContextGetStatistics();
+    XCTAssertEqual(statistics.createdComponentCount + statistics.reusedComponentCount, attributes.size());
+    XCTAssertLessThan(statistics.createdComponentCount, attributes.size() / 2);
+  }];
+}
+
+- (void)testReusedTextKitComponentsLayOutLikeNewOnes
+{
+  CKTextKitAttributes longAttributes {
+    .attributedString = [[NSAttributedString alloc] initWithString:@"A string long enough to wrap onto a few lines when it is constrained"],
+    .maximumNumberOfLines = 2,
+  };
+  CKTextKitAttributes shortAttributes {
+    .attributedString = [[NSAttributedString alloc] initWithString:@"Short"]
+  };
+  CGSize firstShortSize;
+  @autoreleasepool {
+    firstShortSize = [[CKTextKitRenderer alloc] initWithTextKitAttributes:shortAttributes constrainedSize:{100, 100}].size;
+    (void)[[CKTextKitRenderer alloc] initWithTextKitAttributes:longAttributes constrainedSize:{100, 100}];
+  }
+  // The next renderer picks up the components of the long, truncated one, which were returned to the pool last.
+  const CKTextKitContextStatistics before = CKTextKitContextGetStatistics();
+  CKTextKitRenderer *renderer = [[CKTextKitRenderer alloc] initWithTextKitAttributes:shortAttributes constrainedSize:{100, 100}];
+  XCTAssertEqual(CKTextKitContextGetStatistics().reusedComponentCount, before.reusedComponentCount + 1);
+  XCTAssertTrue(CGSizeEqualToSize(renderer.size, firstShortSize));
+  XCTAssertEqual(renderer.lineCount, 1u);
+}
+
 @end
@@ -11,7 +11,9 @@
 #import <Foundation/Foundation.h>
 #import <XCTest/XCTest.h>
 
+#import <ComponentKit/CKTextKitAttributes.h>
 #import <ComponentKit/CKTextKitContext.h>
+#import <ComponentKit/CKTextKitRenderer.h>
 #import <ComponentKit/CKTextKitTailTruncater.h>
 
 @interface CKTextKitTruncationTests : XCTestCase
@@ -121,4 +123,43 @@
   XCTAssertEqualObjects(expectedString, drawnString);
 }
 
+- (NSAttributedString *)_longPostAttributedString
+{
+  NSMutableString *post = [NSMutableString string];
+  for (NSUInteger paragraph = 0; paragraph < 20; paragraph++) {
+    for (NSUInteger sentence = 0; sentence < 4; sentence++) {
+      [post appendString:[self _sentenceString]];
+      [post appendString:@" "];
+    }
+    [post appendString:@"\n\n"];
+  }
+  return [[NSAttributedString alloc] initWithString:post
+                                         attributes:@{NSFontAttributeName : [UIFont systemFontOfSize:14]}];
+}
+
+- (void)testTruncatingLongPostsToAFewLines
+{
+  NSAttributedString *post = [self _longPostAttributedString];
+  NSAttributedString *truncationString = [[NSAttributedString alloc] initWithString:@"... See More"
+                                                                         attributes:@{NSFontAttributeName : [UIFont systemFontOfSize:14]}];
+  [self measureBlock:^{
+    for (NSUInteger lines = 3; lines <= 5; lines++) {
+      for (CGFloat width = 280; width <= 320; width += 8) {
+        CKTextKitRenderer *renderer =
+        [[CKTextKitRenderer alloc] initWithTextKitAttributes:{
+          .attributedString = post,
+          .truncationAttributedString = truncationString,
+          .maximumNumberOfLines = lines,
+        } constrainedSize:{width, CGFLOAT_MAX}];
+        XCTAssertLessThan(renderer.visibleRanges[0].length, post.length);
+        __block NSString *drawnString;
+        [renderer.context performBlockWithLockedTextKitComponents:^(NSLayoutManager *layoutManager, NSTextStorage *textStorage, NSTextContainer *textContainer) {
+          drawnString = textStorage.string;
+        }];
+        XCTAssertTrue([drawnString hasSuffix:@"... See More"]);
+      }
+    }
+  }];
+}
+
 @end